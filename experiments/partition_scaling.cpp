@@ -0,0 +1,223 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+  Scaling of split-optimize-reunite: sweeps the partitioner, the number of
+  blocks and the number of threads over the EPFL and IWLS benchmarks and
+  records the wall time of every stage, the peak memory and the QoR after
+  the reunion.
+
+  mt-KaHyPar is initialized once with all hardware threads, so the thread
+  sweep applies to the block extraction, optimization and reunion.  The
+  peak RSS is reset before every row (Linux only, 0 elsewhere), so it is
+  the peak while that row extracts, optimizes and reunites the blocks.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <lorina/aiger.hpp>
+#include <mockturtle/algorithms/aig_resub.hpp>
+#include <mockturtle/algorithms/cleanup.hpp>
+#include <mockturtle/algorithms/native_partition.hpp>
+#include <mockturtle/algorithms/partition_optimization.hpp>
+#include <mockturtle/io/aiger_reader.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/utils/stopwatch.hpp>
+#include <mockturtle/views/depth_view.hpp>
+#include <mockturtle/views/partition_view.hpp>
+#include <mtkahypar.h>
+
+#include <experiments.hpp>
+
+/* resets the peak resident set size of the process, false if not supported */
+bool reset_peak_rss()
+{
+#if defined( __linux__ )
+  std::ofstream clear_refs( "/proc/self/clear_refs" );
+  return static_cast<bool>( clear_refs << "5" << std::flush );
+#else
+  return false;
+#endif
+}
+
+/* peak resident set size of the process since the last reset in MiB, 0 if unknown */
+double peak_rss_mib()
+{
+#if defined( __linux__ )
+  std::ifstream status( "/proc/self/status" );
+  std::string line;
+  while ( std::getline( status, line ) )
+  {
+    if ( line.rfind( "VmHWM:", 0u ) == 0u )
+    {
+      return std::stod( line.substr( 6u ) ) / 1024.0; /* kB */
+    }
+  }
+#endif
+  return 0.0;
+}
+
+std::optional<std::vector<mockturtle::partition_view::block_id>> mt_kahypar_partition( mockturtle::partition_view const& aig_p )
+{
+  auto const& ps = aig_p.params();
+  mt_kahypar_error_t error{};
+  mt_kahypar_context_t* context = mt_kahypar_context_from_preset( DETERMINISTIC );
+  mt_kahypar_set_partitioning_parameters( context, ps.num_blocks, ps.epsilon, KM1 );
+  mt_kahypar_set_seed( ps.seed );
+  mt_kahypar_set_context_parameter( context, VERBOSE, "0", &error );
+
+  std::optional<std::vector<mockturtle::partition_view::block_id>> node_block;
+  mt_kahypar_hypergraph_t hypergraph = aig_p.create_hypergraph( context, &error );
+  if ( hypergraph.hypergraph != nullptr )
+  {
+    mt_kahypar_partitioned_hypergraph_t partitioned_hg = mt_kahypar_partition( hypergraph, context, &error );
+    if ( partitioned_hg.partitioned_hg != nullptr )
+    {
+      std::vector<mt_kahypar_partition_id_t> partition( aig_p.num_vertices() );
+      mt_kahypar_get_partition( partitioned_hg, partition.data() );
+      node_block = aig_p.node_to_block( partition.data(), partition.size() );
+      mt_kahypar_free_partitioned_hypergraph( partitioned_hg );
+    }
+    mt_kahypar_free_hypergraph( hypergraph );
+  }
+  if ( !node_block )
+  {
+    fmt::print( "[e] mt-KaHyPar failed: {}\n", error.msg ? error.msg : "" );
+    mt_kahypar_free_error_content( &error );
+  }
+  mt_kahypar_free_context( context );
+  return node_block;
+}
+
+int main()
+{
+  using namespace experiments;
+  using namespace mockturtle;
+
+  experiment<std::string, std::string, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+             double, double, double, double, double, double, double, double>
+      exp( "partition_scaling", "benchmark", "partitioner", "blocks", "threads", "cut", "size_before", "size_after", "depth_before", "depth_after",
+           "t_total", "t_build", "t_partition", "t_extract", "t_optimize", "t_reunite", "speedup", "peak_rss_mib" );
+
+  uint32_t const max_threads = std::max( 1u, std::thread::hardware_concurrency() );
+  mt_kahypar_initialize( max_threads, true );
+
+  std::vector<uint32_t> threads;
+  for ( auto t = 1u; t < max_threads; t *= 2u )
+  {
+    threads.push_back( t );
+  }
+  threads.push_back( max_threads );
+
+  auto benchmarks = epfl_benchmarks();
+  auto const iwls = iwls_benchmarks();
+  benchmarks.insert( benchmarks.end(), iwls.begin(), iwls.end() );
+
+  for ( auto const& benchmark : benchmarks )
+  {
+    if ( benchmark == "hyp" )
+    {
+      continue;
+    }
+    fmt::print( "[i] processing {}\n", benchmark );
+    aig_network aig;
+    if ( lorina::read_aiger( benchmark_path( benchmark ), aiger_reader( aig ) ) != lorina::return_code::success )
+    {
+      continue;
+    }
+    uint32_t const size_before = aig.num_gates();
+    uint32_t const depth_before = depth_view{ aig }.depth();
+
+    for ( std::string const partitioner : { "mt-kahypar", "native" } )
+    {
+      for ( int32_t num_blocks : { 2, 4, 8, 16, 32, 64 } )
+      {
+        if ( uint32_t( num_blocks ) * 64u > size_before )
+        {
+          break;
+        }
+
+        partition_view_params ps;
+        ps.num_blocks = num_blocks;
+        partition_view aig_p{ aig, ps };
+
+        stopwatch<>::duration time_partition{ 0 };
+        auto const node_block = call_with_stopwatch( time_partition, [&]() -> std::optional<std::vector<partition_view::block_id>> {
+          if ( partitioner == "native" )
+          {
+            return native_partition( aig_p );
+          }
+          return mt_kahypar_partition( aig_p );
+        } );
+        if ( !node_block )
+        {
+          continue;
+        }
+        /* the hypergraph is built on the first access by the partitioner */
+        auto const time_build = aig_p.stats().time_build;
+        time_partition -= time_build;
+
+        double time_single = 0.0;
+        for ( auto const& num_threads : threads )
+        {
+          bool const rss_reset = reset_peak_rss();
+
+          /* the view extracts the blocks and builds the reunion with its own thread count */
+          partition_view_params sweep_ps = ps;
+          sweep_ps.num_threads = num_threads;
+          partition_view sweep_p{ aig, sweep_ps };
+
+          partition_optimization_params opt_ps;
+          opt_ps.num_threads = num_threads;
+          partition_optimization_stats opt_st;
+          partition_optimizer opt( opt_ps, opt_st );
+          opt.add_script( []( aig_network& ntk ) {
+            aig_resubstitution( ntk );
+            ntk = cleanup_dangling( ntk );
+          } );
+          auto const res = opt.run( sweep_p, *node_block );
+
+          auto const time_total = to_seconds( time_build ) + to_seconds( time_partition ) + to_seconds( opt_st.time_total );
+          time_single = num_threads == threads.front() ? time_total : time_single;
+          exp( benchmark, partitioner, num_blocks, num_threads, sweep_p.stats().num_cut_hyperedges, size_before, res.num_gates(), depth_before, depth_view{ res }.depth(),
+               time_total, to_seconds( time_build ), to_seconds( time_partition ), to_seconds( opt_st.time_extract ), to_seconds( opt_st.time_optimize ),
+               to_seconds( opt_st.time_reunite ), time_single / time_total, rss_reset ? peak_rss_mib() : 0.0 );
+        }
+      }
+    }
+  }
+
+  exp.save();
+  exp.table();
+
+  return 0;
+}
@@ -107,7 +107,6 @@ int main()
     auto aig_depth_before = d_aig.depth();
 
     partition_view_params ps;
-    ps.file_name = fmt::format( "{}/tmp_ctrl.hmetis", pHyOutS );
     partition_view aig_p{ aig, ps };
 
     // Althernative ABC method
@@ -140,10 +139,8 @@ int main()
         mt_kahypar_set_context_parameter( context, VERBOSE, "0", &error );
     assert( status == SUCCESS );
 
-    // Load Hypergraph for DEFAULT preset
-    mt_kahypar_hypergraph_t hypergraph =
-        mt_kahypar_read_hypergraph_from_file( fmt::format( "{}/tmp_ctrl.hmetis", pHyOutS ).c_str(),
-                                              context, HMETIS /* file format */, &error );
+    // Hand the hypergraph over in memory, set ps.write_hmetis to also dump it for debugging
+    mt_kahypar_hypergraph_t hypergraph = aig_p.create_hypergraph( context, &error );
     if ( hypergraph.hypergraph == nullptr )
     {
       std::cout << error.msg << std::endl;
@@ -213,7 +210,7 @@ int main()
 
     auto vAigs = aig_p.construct_from_partition( ps.num_blocks, partition, hypergraph );
 
-    // Now insert all the aigs back to original ntk and check the equivalence
+    // Now optimize all the parts, stitch them back to the original ntk and check the equivalence
     int iCount = 0;
     for ( auto& aig_part : vAigs )
     {
@@ -228,8 +225,6 @@ int main()
       convert_klut_to_graph<aig_network>( aig_p_t_b, klut_m );
       std::get<0>( aig_part ) = aig_p_t_b;
 
-      aig_p.insert_back( aig_part );
-
       if ( remove( fmt::format( "{}/{}_part_{}", pHyOutS, benchmark, iCount ).c_str() ) == 0 )
       {
         std::cout << "Successfully deleted the tmp file." << std::endl;
@@ -242,11 +237,11 @@ int main()
       iCount++;
     }
 
-    auto aig_clear = cleanup_dangling( aig );
-    color_view f_c_aig{ aig_clear };
+    // Stitch all parts back in one pass, no dangling nodes are left behind
+    aig = aig_p.reunite( vAigs );
+    color_view f_c_aig{ aig };
     assert( count_reachable_dead_nodes( f_c_aig ) == 0u );
     assert( network_is_acyclic( f_c_aig ) );
-    aig = aig_clear;
 
     auto final_gate_num = aig.num_gates();
     depth_view d_aig_final{ aig };
@@ -287,15 +282,6 @@ int main()
     // alternative without file write out, using:
     // mt_kahypar_partitioned_hypergraph_t partitioned_hg_sep = mt_kahypar_create_partitioned_hypergraph(hypergraph, context, 3, partition.get(), &error);
 
-    if ( remove( fmt::format( "{}/tmp.hmetis", pHyOutS ).c_str() ) == 0 )
-    {
-      std::cout << "Successfully deleted the tmp file." << std::endl;
-    }
-    else
-    {
-      std::cout << "Failed to delete the tmp file." << std::endl;
-    }
-
     mt_kahypar_free_context( context );
     mt_kahypar_free_hypergraph( hypergraph );
     mt_kahypar_free_partitioned_hypergraph( partitioned_hg );
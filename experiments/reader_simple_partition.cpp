@@ -8,6 +8,7 @@
 #include <memory>
 #include <mockturtle/algorithms/klut_to_graph.hpp>
 #include <mockturtle/algorithms/lut_mapper.hpp>
+#include <mockturtle/algorithms/partition_optimization.hpp>
 #include <mockturtle/io/aiger_reader.hpp>
 #include <mockturtle/networks/aig.hpp>
 #include <mockturtle/networks/klut.hpp>
@@ -100,7 +101,6 @@ int main()
     auto ori_gate_num = aig.num_gates();
 
     partition_view_params ps;
-    ps.file_name = fmt::format( "{}/tmp_ctrl.hmetis", pHyOutS );
     partition_view aig_p{ aig, ps };
 
     // Althernative ABC method
@@ -134,10 +134,8 @@ int main()
         mt_kahypar_set_context_parameter( context, VERBOSE, "0", &error );
     assert( status == SUCCESS );
 
-    // Load Hypergraph for DEFAULT preset
-    mt_kahypar_hypergraph_t hypergraph =
-        mt_kahypar_read_hypergraph_from_file( fmt::format( "{}/tmp_ctrl.hmetis", pHyOutS ).c_str(),
-                                              context, HMETIS /* file format */, &error );
+    // Hand the hypergraph over in memory, set ps.write_hmetis to also dump it for debugging
+    mt_kahypar_hypergraph_t hypergraph = aig_p.create_hypergraph( context, &error );
     if ( hypergraph.hypergraph == nullptr )
     {
       std::cout << error.msg << std::endl;
@@ -210,35 +208,38 @@ int main()
     std::cout << "Original aig PI num: " << aig.num_pis() << std::endl;
     std::cout << "Original aig PO num: " << aig.num_pos() << std::endl;
 
-    auto vAigs = aig_p.construct_from_partition( ps.num_blocks, partition, hypergraph );
-
-    // Now insert all the aigs back to original ntk and check the equivalence
-    for ( auto& aig_part : vAigs )
-    {
-
-      klut_network klut_a = lut_map( std::get<0>( aig_part ) );
+    // Now optimize all the parts concurrently, keep the improved ones and stitch them back
+    partition_optimization_params opt_ps;
+    opt_ps.verify = true;
+    partition_optimization_stats opt_st;
+    partition_optimizer opt( opt_ps, opt_st );
+    opt.add_script( []( aig_network& ntk ) {
+      klut_network klut_a = lut_map( ntk );
       mig_network mig_IR;
       convert_klut_to_graph<mig_network>( mig_IR, klut_a );
       klut_network klut_m = lut_map( mig_IR );
       aig_network aig_p_t_b;
       convert_klut_to_graph<aig_network>( aig_p_t_b, klut_m );
-      std::get<0>( aig_part ) = aig_p_t_b;
-
-      aig_p.insert_back( aig_part );
-    }
-
-    auto aig_clear = cleanup_dangling( aig );
-    color_view f_c_aig{ aig_clear };
+      ntk = aig_p_t_b;
+    } );
+    aig = opt.run( aig_p, aig_p.node_to_block( partition.get(), mt_kahypar_num_hypernodes( hypergraph ) ) );
+    opt_st.report();
+    aig_p.stats().report();
+    color_view f_c_aig{ aig };
     assert( count_reachable_dead_nodes( f_c_aig ) == 0u );
     assert( network_is_acyclic( f_c_aig ) );
-    aig = aig_clear;
 
     auto final_gate_num = aig.num_gates();
     std::cout << "Original gate number " << ori_gate_num << " Final gate number " << final_gate_num << std::endl;
 
-    // equivalence check
+    // equivalence check: the per-block miters do not cover the reunion, so check the whole design as well
+    std::cout << "Blocks not proven equivalent by their miters (kept original) " << opt_st.num_unverified << std::endl;
     const auto cec1 = benchmark == "hyp" ? true : abc_cec( aig, benchmark );
-    assert( cec1 == true );
+    if ( !cec1 )
+    {
+      std::cerr << "[e] " << benchmark << " is not equivalent to the original after the reunion" << std::endl;
+      return 1;
+    }
     std::cout << "*****EQ CHEKCED*****" << std::endl;
 
     // Extract Block Weights
@@ -0,0 +1,144 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+  Structural hashing on the EPFL benchmarks: replays the strash lookups and
+  insertions of reading each AIG (one `find` per gate, followed by an
+  insertion) on the `strash_table` of `aig_storage` and on the previous
+  `phmap::flat_hash_map` keyed by the full node, including its reserve
+  policy.  Reports the time and the table memory of both, and the time of
+  reading the AIG and of `cleanup_dangling` with the current storage.
+*/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <lorina/aiger.hpp>
+#include <mockturtle/algorithms/cleanup.hpp>
+#include <mockturtle/io/aiger_reader.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/utils/stopwatch.hpp>
+#include <parallel_hashmap/phmap.h>
+
+#include <experiments.hpp>
+
+using namespace mockturtle;
+
+/* one lookup per gate and an insertion on every miss, repeated `rounds` times on a fresh table;
+   `on_grow` is called on construction and whenever `aig_network::create_and` grows the node vector */
+template<typename Table, typename OnGrow>
+uint64_t replay( std::vector<aig_storage::node_type> const& nodes, uint64_t first_index, uint32_t rounds, OnGrow&& on_grow, uint64_t& bytes )
+{
+  uint64_t checksum = 0u;
+  for ( auto r = 0u; r < rounds; ++r )
+  {
+    Table table;
+    uint64_t node_capacity = 10000u;
+    on_grow( table, node_capacity );
+    for ( auto i = 0u; i < nodes.size(); ++i )
+    {
+      if ( auto const it = table.find( nodes[i] ); it != table.end() )
+      {
+        checksum += it->second;
+        continue;
+      }
+      uint64_t const index = first_index + i;
+      if ( index >= .9 * node_capacity )
+      {
+        node_capacity = static_cast<uint64_t>( 3.1415f * index );
+        on_grow( table, node_capacity );
+      }
+      table[nodes[i]] = index;
+    }
+    checksum += table.size();
+    bytes = table.capacity() * sizeof( typename Table::value_type );
+  }
+  return checksum;
+}
+
+int main()
+{
+  using namespace experiments;
+
+  using phmap_table = phmap::flat_hash_map<aig_storage::node_type, uint64_t, aig_hash<aig_storage::node_type>>;
+
+  experiment<std::string, uint32_t, double, double, double, double, double, double, double>
+      exp( "strash_table", "benchmark", "gates", "t_phmap", "t_strash", "speedup", "mib_phmap", "mib_strash", "t_read", "t_cleanup" );
+
+  uint32_t const rounds = 10u;
+  for ( auto const& benchmark : epfl_benchmarks() )
+  {
+    fmt::print( "[i] processing {}\n", benchmark );
+    aig_network aig;
+    stopwatch<>::duration time_read{ 0 };
+    auto const result = call_with_stopwatch( time_read, [&]() {
+      return lorina::read_aiger( benchmark_path( benchmark ), aiger_reader( aig ) );
+    } );
+    if ( result != lorina::return_code::success )
+    {
+      continue;
+    }
+
+    stopwatch<>::duration time_cleanup{ 0 };
+    call_with_stopwatch( time_cleanup, [&]() { aig = cleanup_dangling( aig ); } );
+
+    std::vector<aig_storage::node_type> nodes;
+    nodes.reserve( aig.num_gates() );
+    aig.foreach_gate( [&]( auto const& n ) {
+      aig_storage::node_type node;
+      aig.foreach_fanin( n, [&]( auto const& fi, auto i ) {
+        node.children[i] = fi;
+      } );
+      nodes.push_back( node );
+    } );
+    uint64_t const first_index = aig.num_pis() + 1u;
+
+    uint64_t bytes_phmap{ 0 }, bytes_strash{ 0 };
+    stopwatch<>::duration time_phmap{ 0 }, time_strash{ 0 };
+    auto const check_phmap = call_with_stopwatch( time_phmap, [&]() {
+      return replay<phmap_table>( nodes, first_index, rounds, []( auto& table, uint64_t capacity ) { table.reserve( capacity ); }, bytes_phmap );
+    } );
+    auto const check_strash = call_with_stopwatch( time_strash, [&]() {
+      return replay<strash_table<aig_storage::node_type>>( nodes, first_index, rounds, []( auto&, uint64_t ) {}, bytes_strash );
+    } );
+    /* one control byte per slot */
+    bytes_phmap += bytes_phmap / sizeof( phmap_table::value_type );
+    if ( check_phmap != check_strash )
+    {
+      fmt::print( "[e] tables disagree on {}\n", benchmark );
+    }
+
+    exp( benchmark, aig.num_gates(), to_seconds( time_phmap ) / rounds, to_seconds( time_strash ) / rounds,
+         to_seconds( time_phmap ) / to_seconds( time_strash ), bytes_phmap / ( 1024.0 * 1024.0 ), bytes_strash / ( 1024.0 * 1024.0 ),
+         to_seconds( time_read ), to_seconds( time_cleanup ) );
+  }
+
+  exp.save();
+  exp.table();
+
+  return 0;
+}
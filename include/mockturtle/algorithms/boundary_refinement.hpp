@@ -0,0 +1,474 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file boundary_refinement.hpp
+  \brief Refines a partition towards fewer block inputs and outputs
+*/
+
+#pragma once
+
+#include "../networks/aig.hpp"
+#include "../utils/stopwatch.hpp"
+#include "../views/partition_view.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+namespace mockturtle
+{
+
+struct boundary_refinement_params
+{
+  /*! \brief Maximum number of FM refinement passes. */
+  uint32_t num_passes{ 8u };
+
+  /*! \brief A pass stops after this many moves without a smaller boundary. */
+  uint32_t max_fruitless_moves{ 200u };
+
+  /*! \brief Gains of the other readers of a fanin are only updated eagerly up to this fanout. */
+  uint32_t max_update_fanout{ 64u };
+
+  /*! \brief Be verbose. */
+  bool verbose{ false };
+};
+
+struct boundary_refinement_stats
+{
+  /*! \brief Total runtime. */
+  stopwatch<>::duration time_total{ 0 };
+
+  /*! \brief Block inputs plus outputs (over all blocks) before the refinement. */
+  int64_t initial_boundary{ 0 };
+
+  /*! \brief Block inputs plus outputs (over all blocks) after the refinement. */
+  int64_t boundary{ 0 };
+
+  /*! \brief Number of kept moves. */
+  uint32_t num_moves{ 0u };
+
+  void report() const
+  {
+    std::cout << fmt::format( "[i] boundary     = {:>8} (initial {})\n", boundary, initial_boundary );
+    std::cout << fmt::format( "[i] moves        = {:>8}\n", num_moves );
+    std::cout << fmt::format( "[i] total time   = {:>8.3f} secs\n", to_seconds( time_total ) );
+  }
+};
+
+namespace detail
+{
+
+class boundary_refinement_impl
+{
+public:
+  using node = aig_network::node;
+  using block_id = partition_view::block_id;
+
+  boundary_refinement_impl( aig_network const& ntk, std::vector<block_id> const& node_block, double epsilon, boundary_refinement_params const& ps, boundary_refinement_stats& st )
+      : ntk( ntk ), ps( ps ), st( st ), epsilon( epsilon ), part( node_block )
+  {
+  }
+
+  std::vector<block_id> run()
+  {
+    stopwatch t( st.time_total );
+
+    init();
+    st.initial_boundary = boundary;
+    for ( auto pass = 0u; pass < ps.num_passes && k > 1u; ++pass )
+    {
+      auto const before = boundary;
+      fm_pass();
+      if ( ps.verbose )
+      {
+        fmt::print( "[i] pass {}: boundary {} -> {}\n", pass, before, boundary );
+      }
+      if ( boundary >= before )
+      {
+        break;
+      }
+    }
+    st.boundary = boundary;
+
+    return part;
+  }
+
+private:
+  /* block of the gate `n`, or -1 for PIs and the constant */
+  block_id owner( node const& n ) const
+  {
+    return ntk.is_and( n ) ? part[n] : -1;
+  }
+
+  void init()
+  {
+    assert( part.size() == ntk.size() );
+    k = 0u;
+    ntk.foreach_gate( [&]( auto const& n ) {
+      k = std::max( k, static_cast<uint32_t>( part[n] ) + 1u );
+    } );
+
+    /* gate readers of every node (with multiplicity) */
+    fanout_indices.assign( ntk.size() + 1u, 0u );
+    ntk.foreach_gate( [&]( auto const& n ) {
+      ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        fanout_indices[ntk.get_node( fi ) + 1u]++;
+      } );
+    } );
+    std::partial_sum( fanout_indices.begin(), fanout_indices.end(), fanout_indices.begin() );
+    fanouts.resize( fanout_indices.back() );
+    std::vector<uint32_t> cursor( fanout_indices.begin(), fanout_indices.end() - 1 );
+    ntk.foreach_gate( [&]( auto const& n ) {
+      ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        fanouts[cursor[ntk.get_node( fi )]++] = n;
+      } );
+    } );
+
+    /* references by POs, fanout_size also counts them */
+    po_refs.assign( ntk.size(), 0u );
+    ntk.foreach_node( [&]( auto const& n ) {
+      po_refs[n] = ntk.fanout_size( n ) - ( fanout_indices[n + 1u] - fanout_indices[n] );
+    } );
+
+    /* reading blocks of every node, at most min( k, #readers ) of them */
+    reader_indices.assign( ntk.size() + 1u, 0u );
+    for ( node n = 0u; n < ntk.size(); ++n )
+    {
+      reader_indices[n + 1u] = reader_indices[n] + std::min( k, fanout_indices[n + 1u] - fanout_indices[n] );
+    }
+    readers.resize( reader_indices.back() );
+    num_readers.assign( ntk.size(), 0u );
+    ntk.foreach_gate( [&]( auto const& n ) {
+      ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        add_reader( ntk.get_node( fi ), static_cast<uint32_t>( part[n] ), 1 );
+      } );
+    } );
+
+    block_gates.assign( k, 0 );
+    ntk.foreach_gate( [&]( auto const& n ) {
+      block_gates[part[n]]++;
+    } );
+    int64_t const average = ( static_cast<int64_t>( ntk.num_gates() ) + k - 1u ) / std::max( k, 1u );
+    max_block_gates = std::max( static_cast<int64_t>( ( 1.0 + epsilon ) * average ),
+                                k == 0u ? int64_t( 0 ) : *std::max_element( block_gates.begin(), block_gates.end() ) );
+
+    boundary = 0;
+    for ( node n = 0u; n < ntk.size(); ++n )
+    {
+      boundary += cost( n, owner( n ), k, 0, k, 0 );
+    }
+  }
+
+  /* adds `delta` references of block `b` to the readers of `n` */
+  void add_reader( node const& n, uint32_t b, int32_t delta )
+  {
+    auto* first = &readers[reader_indices[n]];
+    auto* last = first + num_readers[n];
+    auto it = std::find_if( first, last, [&]( auto const& r ) { return r.first == b; } );
+    if ( it == last )
+    {
+      assert( delta > 0 && reader_indices[n] + num_readers[n] < reader_indices[n + 1u] );
+      *it = { b, 0u };
+      ++num_readers[n];
+    }
+    it->second += delta;
+    if ( it->second == 0u )
+    {
+      *it = *( last - 1 );
+      --num_readers[n];
+    }
+  }
+
+  /* inputs plus outputs `n` accounts for if it belongs to block `own`, with
+     `da` references moved to block `a` and `db` references to block `b` */
+  int64_t cost( node const& n, block_id own, uint32_t a, int32_t da, uint32_t b, int32_t db ) const
+  {
+    int64_t external = 0;
+    bool reads_b = false;
+    for ( auto i = reader_indices[n]; i < reader_indices[n] + num_readers[n]; ++i )
+    {
+      auto const& [blk, count] = readers[i];
+      auto const refs = static_cast<int64_t>( count ) + ( blk == a ? da : 0 ) + ( blk == b ? db : 0 );
+      reads_b = reads_b || blk == b;
+      external += refs > 0 && static_cast<block_id>( blk ) != own ? 1 : 0;
+    }
+    if ( !reads_b && b < k && db > 0 && static_cast<block_id>( b ) != own )
+    {
+      ++external;
+    }
+    /* a gate is an output of its block if a PO or another block reads it */
+    return external + ( own >= 0 && ( po_refs[n] > 0u || external > 0 ) ? 1 : 0 );
+  }
+
+  /* decrease of the boundary when moving gate `v` to block `to` */
+  int64_t gain( node const& v, uint32_t to ) const
+  {
+    auto const from = static_cast<uint32_t>( part[v] );
+    int64_t g = cost( v, from, k, 0, k, 0 ) - cost( v, to, k, 0, k, 0 );
+
+    std::array<node, 2u> fanins;
+    auto num_fanins = 0u;
+    ntk.foreach_fanin( v, [&]( auto const& fi ) {
+      fanins[num_fanins++] = ntk.get_node( fi );
+    } );
+    if ( num_fanins == 2u && fanins[0] == fanins[1] )
+    {
+      auto const u = fanins[0];
+      return g + cost( u, owner( u ), k, 0, k, 0 ) - cost( u, owner( u ), from, -2, to, 2 );
+    }
+    for ( auto i = 0u; i < num_fanins; ++i )
+    {
+      auto const u = fanins[i];
+      g += cost( u, owner( u ), k, 0, k, 0 ) - cost( u, owner( u ), from, -1, to, 1 );
+    }
+    return g;
+  }
+
+  /* best move of gate `v` into an adjacent block with room, as ( gain, target ) */
+  std::pair<int64_t, uint32_t> best_move( node const& v )
+  {
+    auto const from = static_cast<uint32_t>( part[v] );
+    candidates.clear();
+    ntk.foreach_fanin( v, [&]( auto const& fi ) {
+      auto const b = owner( ntk.get_node( fi ) );
+      if ( b >= 0 )
+      {
+        candidates.push_back( static_cast<uint32_t>( b ) );
+      }
+    } );
+    for ( auto i = reader_indices[v]; i < reader_indices[v] + num_readers[v]; ++i )
+    {
+      candidates.push_back( readers[i].first );
+    }
+
+    std::pair<int64_t, uint32_t> best{ std::numeric_limits<int64_t>::min(), k };
+    for ( auto const& b : candidates )
+    {
+      if ( b == from || b == best.second || block_gates[b] + 1 > max_block_gates )
+      {
+        continue;
+      }
+      auto const g = gain( v, b );
+      if ( g > best.first || ( g == best.first && b < best.second ) )
+      {
+        best = { g, b };
+      }
+    }
+    return best;
+  }
+
+  void move( node const& v, uint32_t to )
+  {
+    auto const from = static_cast<uint32_t>( part[v] );
+    boundary -= gain( v, to );
+    ntk.foreach_fanin( v, [&]( auto const& fi ) {
+      /* remove first, the readers of a fanin have no spare slot */
+      add_reader( ntk.get_node( fi ), from, -1 );
+      add_reader( ntk.get_node( fi ), to, 1 );
+    } );
+    block_gates[from]--;
+    block_gates[to]++;
+    part[v] = static_cast<block_id>( to );
+  }
+
+  /* one FM pass over the gates with lazy gain updates, rolled back to the smallest boundary */
+  void fm_pass()
+  {
+    using entry = std::tuple<int64_t, node, uint32_t>;
+    std::priority_queue<entry> queue;
+    version.assign( ntk.size(), 0u );
+    locked.assign( ntk.size(), 0u );
+
+    auto push = [&]( node const& v ) {
+      if ( !ntk.is_and( v ) || locked[v] )
+      {
+        return;
+      }
+      ++version[v];
+      auto const [g, to] = best_move( v );
+      if ( to < k )
+      {
+        queue.emplace( g, v, version[v] );
+      }
+    };
+
+    ntk.foreach_gate( [&]( auto const& n ) {
+      push( n );
+    } );
+
+    std::vector<std::pair<node, uint32_t>> moves;
+    std::vector<node> touched;
+    auto best_boundary = boundary;
+    auto best_prefix = 0u;
+    auto fruitless = 0u;
+    while ( !queue.empty() && fruitless < ps.max_fruitless_moves )
+    {
+      auto const [g, v, ver] = queue.top();
+      queue.pop();
+      if ( locked[v] || ver != version[v] )
+      {
+        continue;
+      }
+
+      /* the gain may be stale when a reader of a high-fanout node moved */
+      auto const [current_gain, to] = best_move( v );
+      if ( to == k )
+      {
+        continue;
+      }
+      if ( current_gain != g )
+      {
+        queue.emplace( current_gain, v, ++version[v] );
+        continue;
+      }
+
+      moves.emplace_back( v, static_cast<uint32_t>( part[v] ) );
+      locked[v] = 1u;
+      move( v, to );
+      if ( boundary < best_boundary )
+      {
+        best_boundary = boundary;
+        best_prefix = static_cast<uint32_t>( moves.size() );
+        fruitless = 0u;
+      }
+      else
+      {
+        ++fruitless;
+      }
+
+      /* the costs of `v` and its fanins changed, which affects the gains
+         of the readers of `v`, the fanins and their other readers */
+      touched.clear();
+      touched.insert( touched.end(), fanouts.begin() + fanout_indices[v], fanouts.begin() + fanout_indices[v + 1u] );
+      ntk.foreach_fanin( v, [&]( auto const& fi ) {
+        auto const u = ntk.get_node( fi );
+        touched.push_back( u );
+        if ( fanout_indices[u + 1u] - fanout_indices[u] <= ps.max_update_fanout )
+        {
+          touched.insert( touched.end(), fanouts.begin() + fanout_indices[u], fanouts.begin() + fanout_indices[u + 1u] );
+        }
+      } );
+      std::sort( touched.begin(), touched.end() );
+      touched.erase( std::unique( touched.begin(), touched.end() ), touched.end() );
+      for ( auto const& u : touched )
+      {
+        push( u );
+      }
+    }
+
+    /* roll back the moves after the smallest boundary */
+    while ( moves.size() > best_prefix )
+    {
+      auto const [v, from] = moves.back();
+      moves.pop_back();
+      move( v, from );
+    }
+    assert( boundary == best_boundary );
+    st.num_moves += best_prefix;
+  }
+
+private:
+  aig_network const& ntk;
+  boundary_refinement_params const& ps;
+  boundary_refinement_stats& st;
+  double const epsilon;
+
+  std::vector<block_id> part;
+  uint32_t k{ 0u };
+  std::vector<uint32_t> fanout_indices;
+  std::vector<node> fanouts;
+  std::vector<uint32_t> po_refs;
+  std::vector<uint32_t> reader_indices;
+  std::vector<std::pair<uint32_t, uint32_t>> readers;
+  std::vector<uint32_t> num_readers;
+  std::vector<int64_t> block_gates;
+  int64_t max_block_gates{ 0 };
+  int64_t boundary{ 0 };
+
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> version;
+  std::vector<uint8_t> locked;
+};
+
+} // namespace detail
+
+/*! \brief Refines a partition to minimize the inputs and outputs of its blocks.
+ *
+ * Partitioners minimize the cut of the hypergraph (km1 or SOED), while the
+ * work of `construct_from_partition` and `reunite` grows with the
+ * boundary of the blocks: every input and output of a block is a PI or PO
+ * of its window and has to be substituted in the reunion.  This pass
+ * takes a partition (e.g., by mt-KaHyPar or `native_partition`) and runs
+ * Fiduccia-Mattheyses passes directly on the sum of inputs plus outputs
+ * over all blocks, as `collect_boundaries` counts them.  A move
+ * reassigns one gate to the block of a fanin or of a reader, as long as
+ * the block stays below `(1 + epsilon)` times the average number of gates
+ * (or the largest block of the given partition, if that is bigger), and
+ * every pass is rolled back to the smallest boundary it has seen.
+ *
+ * Only gates are moved, the blocks of PIs do not matter for the
+ * extraction.  Returns the refined dense node-to-block vector, with the
+ * same block ids as `node_block`.
+ *
+ * **Example**
+ *
+   \verbatim embed:rst
+
+   .. code-block:: c++
+
+      auto node_block = aig_p.node_to_block( partition.get(), aig_p.num_vertices() );
+      node_block = boundary_refinement( aig_p, node_block );
+      auto parts = aig_p.construct_from_partition( ps.num_blocks, node_block );
+   \endverbatim
+ */
+inline std::vector<partition_view::block_id> boundary_refinement( partition_view const& aig_p, std::vector<partition_view::block_id> const& node_block,
+                                                                  boundary_refinement_params const& ps = {}, boundary_refinement_stats* pst = nullptr )
+{
+  boundary_refinement_stats st;
+  detail::boundary_refinement_impl p( aig_p.network(), node_block, aig_p.params().epsilon, ps, st );
+  auto const result = p.run();
+
+  if ( ps.verbose )
+  {
+    st.report();
+  }
+  if ( pst )
+  {
+    *pst = st;
+  }
+  return result;
+}
+
+} // namespace mockturtle
@@ -0,0 +1,442 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file native_partition.hpp
+  \brief Lightweight in-tree hypergraph partitioner
+*/
+
+#pragma once
+
+#include "../utils/stopwatch.hpp"
+#include "../views/partition_view.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+namespace mockturtle
+{
+
+struct native_partition_params
+{
+  /*! \brief Maximum number of FM refinement passes. */
+  uint32_t num_passes{ 8u };
+
+  /*! \brief A pass stops after this many moves without a better cut. */
+  uint32_t max_fruitless_moves{ 200u };
+
+  /*! \brief Be verbose. */
+  bool verbose{ false };
+};
+
+struct native_partition_stats
+{
+  /*! \brief Total runtime. */
+  stopwatch<>::duration time_total{ 0 };
+
+  /*! \brief Runtime of the initial partition. */
+  stopwatch<>::duration time_initial{ 0 };
+
+  /*! \brief Runtime of the refinement. */
+  stopwatch<>::duration time_refine{ 0 };
+
+  /*! \brief Connectivity (km1) of the initial partition. */
+  int64_t initial_km1{ 0 };
+
+  /*! \brief Connectivity (km1) of the final partition. */
+  int64_t km1{ 0 };
+
+  /*! \brief Number of kept moves. */
+  uint32_t num_moves{ 0u };
+
+  void report() const
+  {
+    std::cout << fmt::format( "[i] km1          = {:>8} (initial {})\n", km1, initial_km1 );
+    std::cout << fmt::format( "[i] moves        = {:>8}\n", num_moves );
+    std::cout << fmt::format( "[i] initial time = {:>8.3f} secs\n", to_seconds( time_initial ) );
+    std::cout << fmt::format( "[i] refine time  = {:>8.3f} secs\n", to_seconds( time_refine ) );
+    std::cout << fmt::format( "[i] total time   = {:>8.3f} secs\n", to_seconds( time_total ) );
+  }
+};
+
+namespace detail
+{
+
+class native_partition_impl
+{
+public:
+  using vertex_id = uint32_t;
+  using block_id = partition_view::block_id;
+
+  native_partition_impl( partition_view const& aig_p, native_partition_params const& ps, native_partition_stats& st )
+      : aig_p( aig_p ), ps( ps ), st( st ),
+        num_vertices( aig_p.num_vertices() ),
+        num_edges( aig_p.num_hyperedges() ),
+        k( static_cast<uint32_t>( std::max( aig_p.params().num_blocks, 1 ) ) ),
+        indices( aig_p.hyperedge_indices() ),
+        pins( aig_p.hyperedges() )
+  {
+  }
+
+  std::vector<block_id> run()
+  {
+    stopwatch t( st.time_total );
+
+    call_with_stopwatch( st.time_initial, [&]() {
+      init_weights();
+      init_incidence();
+      initial_partition();
+    } );
+    st.initial_km1 = km1;
+
+    call_with_stopwatch( st.time_refine, [&]() {
+      for ( auto pass = 0u; pass < ps.num_passes && k > 1u; ++pass )
+      {
+        auto const before = km1;
+        fm_pass();
+        if ( ps.verbose )
+        {
+          fmt::print( "[i] pass {}: km1 {} -> {}\n", pass, before, km1 );
+        }
+        if ( km1 >= before )
+        {
+          break;
+        }
+      }
+    } );
+    st.km1 = km1;
+
+    return aig_p.node_to_block( part.data(), part.size() );
+  }
+
+private:
+  void init_weights()
+  {
+    edge_weight.assign( num_edges, 1 );
+    if ( aig_p.use_hyperedge_weights() )
+    {
+      auto const& w = aig_p.hyperedge_weights();
+      std::copy( w.begin(), w.end(), edge_weight.begin() );
+    }
+    vertex_weight.assign( num_vertices, 1 );
+    if ( aig_p.use_vertex_weights() )
+    {
+      auto const& w = aig_p.vertex_weights();
+      std::copy( w.begin(), w.end(), vertex_weight.begin() );
+    }
+  }
+
+  /* transposed CSR: hyperedges of every vertex */
+  void init_incidence()
+  {
+    vertex_indices.assign( num_vertices + 1u, 0u );
+    for ( auto const& v : pins )
+    {
+      vertex_indices[v + 1u]++;
+    }
+    std::partial_sum( vertex_indices.begin(), vertex_indices.end(), vertex_indices.begin() );
+    vertex_edges.resize( pins.size() );
+    std::vector<uint32_t> cursor( vertex_indices.begin(), vertex_indices.end() - 1 );
+    for ( auto e = 0u; e < num_edges; ++e )
+    {
+      for ( auto i = indices[e]; i < indices[e + 1]; ++i )
+      {
+        vertex_edges[cursor[pins[i]]++] = e;
+      }
+    }
+  }
+
+  /* chunks of equal weight in topological order, every source right before its first reader */
+  void initial_partition()
+  {
+    /* the first pin of a hyperedge is its source, the other pins read it */
+    std::vector<uint64_t> key( num_vertices );
+    for ( vertex_id v = 0u; v < num_vertices; ++v )
+    {
+      key[v] = 2u * uint64_t( v );
+    }
+    for ( auto e = 0u; e < num_edges; ++e )
+    {
+      auto const first_reader = *std::min_element( pins.begin() + indices[e] + 1u, pins.begin() + indices[e + 1] );
+      key[pins[indices[e]]] = 2u * uint64_t( first_reader ) - 1u;
+    }
+    std::vector<vertex_id> order( num_vertices );
+    std::iota( order.begin(), order.end(), 0u );
+    std::sort( order.begin(), order.end(), [&]( auto const& a, auto const& b ) {
+      return std::tie( key[a], a ) < std::tie( key[b], b );
+    } );
+
+    int64_t const total = std::accumulate( vertex_weight.begin(), vertex_weight.end(), int64_t( 0 ) );
+    max_block_weight = static_cast<int64_t>( ( 1.0 + aig_p.params().epsilon ) * ( ( total + k - 1u ) / k ) );
+    part.assign( num_vertices, 0 );
+    block_weight.assign( k, 0 );
+    int64_t prefix = 0;
+    for ( auto const& v : order )
+    {
+      part[v] = static_cast<mt_kahypar_partition_id_t>( std::min<int64_t>( prefix * k / std::max<int64_t>( total, 1 ), k - 1u ) );
+      block_weight[part[v]] += vertex_weight[v];
+      prefix += vertex_weight[v];
+    }
+
+    pin_count.assign( uint64_t( num_edges ) * k, 0u );
+    km1 = 0;
+    for ( auto e = 0u; e < num_edges; ++e )
+    {
+      uint32_t lambda = 0u;
+      for ( auto i = indices[e]; i < indices[e + 1]; ++i )
+      {
+        lambda += pin_count[uint64_t( e ) * k + part[pins[i]]]++ == 0u ? 1u : 0u;
+      }
+      km1 += int64_t( edge_weight[e] ) * ( lambda - 1u );
+    }
+  }
+
+  /* best move of `v` into an adjacent block with room, as ( gain, target ) */
+  std::pair<int64_t, uint32_t> best_move( vertex_id v )
+  {
+    auto const from = static_cast<uint32_t>( part[v] );
+    int64_t removed = 0, total = 0;
+    std::fill( connected.begin(), connected.end(), 0 );
+    for ( auto i = vertex_indices[v]; i < vertex_indices[v + 1]; ++i )
+    {
+      auto const e = vertex_edges[i];
+      auto const* phi = &pin_count[uint64_t( e ) * k];
+      total += edge_weight[e];
+      removed += phi[from] == 1u ? edge_weight[e] : 0;
+      for ( auto b = 0u; b < k; ++b )
+      {
+        connected[b] += phi[b] > 0u ? edge_weight[e] : 0;
+      }
+    }
+
+    std::pair<int64_t, uint32_t> best{ std::numeric_limits<int64_t>::min(), k };
+    for ( auto b = 0u; b < k; ++b )
+    {
+      if ( b == from || connected[b] == 0 || block_weight[b] + vertex_weight[v] > max_block_weight )
+      {
+        continue;
+      }
+      auto const gain = removed - total + connected[b];
+      if ( gain > best.first )
+      {
+        best = { gain, b };
+      }
+    }
+    return best;
+  }
+
+  void move( vertex_id v, uint32_t to, std::vector<vertex_id>* touched )
+  {
+    auto const from = static_cast<uint32_t>( part[v] );
+    for ( auto i = vertex_indices[v]; i < vertex_indices[v + 1]; ++i )
+    {
+      auto const e = vertex_edges[i];
+      auto* phi = &pin_count[uint64_t( e ) * k];
+      auto const from_after = --phi[from];
+      auto const to_after = ++phi[to];
+      km1 -= from_after == 0u ? edge_weight[e] : 0;
+      km1 += to_after == 1u ? edge_weight[e] : 0;
+
+      /* gains of the other pins only change in these cases */
+      if ( touched && ( from_after <= 1u || to_after <= 2u ) )
+      {
+        for ( auto j = indices[e]; j < indices[e + 1]; ++j )
+        {
+          touched->push_back( static_cast<vertex_id>( pins[j] ) );
+        }
+      }
+    }
+    block_weight[from] -= vertex_weight[v];
+    block_weight[to] += vertex_weight[v];
+    part[v] = static_cast<mt_kahypar_partition_id_t>( to );
+  }
+
+  /* one k-way FM pass with lazy gain updates, rolled back to the best cut */
+  void fm_pass()
+  {
+    using entry = std::tuple<int64_t, vertex_id, uint32_t>;
+    std::priority_queue<entry> queue;
+    version.assign( num_vertices, 0u );
+    locked.assign( num_vertices, 0u );
+    connected.assign( k, 0 );
+
+    auto push = [&]( vertex_id v ) {
+      auto const [gain, to] = best_move( v );
+      if ( to < k )
+      {
+        queue.emplace( gain, v, version[v] );
+      }
+    };
+
+    /* boundary vertices */
+    for ( vertex_id v = 0u; v < num_vertices; ++v )
+    {
+      for ( auto i = vertex_indices[v]; i < vertex_indices[v + 1]; ++i )
+      {
+        auto const* phi = &pin_count[uint64_t( vertex_edges[i] ) * k];
+        if ( phi[part[v]] != indices[vertex_edges[i] + 1] - indices[vertex_edges[i]] )
+        {
+          push( v );
+          break;
+        }
+      }
+    }
+
+    std::vector<std::pair<vertex_id, uint32_t>> moves;
+    std::vector<vertex_id> touched;
+    auto best_km1 = km1;
+    auto best_prefix = 0u;
+    auto fruitless = 0u;
+    while ( !queue.empty() && fruitless < ps.max_fruitless_moves )
+    {
+      auto const [gain, v, ver] = queue.top();
+      queue.pop();
+      if ( locked[v] || ver != version[v] )
+      {
+        continue;
+      }
+
+      /* the target block may have filled up in the meantime */
+      auto const [current_gain, to] = best_move( v );
+      if ( to == k )
+      {
+        continue;
+      }
+      if ( current_gain != gain )
+      {
+        queue.emplace( current_gain, v, ++version[v] );
+        continue;
+      }
+
+      moves.emplace_back( v, static_cast<uint32_t>( part[v] ) );
+      locked[v] = 1u;
+      touched.clear();
+      move( v, to, &touched );
+      if ( km1 < best_km1 )
+      {
+        best_km1 = km1;
+        best_prefix = static_cast<uint32_t>( moves.size() );
+        fruitless = 0u;
+      }
+      else
+      {
+        ++fruitless;
+      }
+
+      std::sort( touched.begin(), touched.end() );
+      touched.erase( std::unique( touched.begin(), touched.end() ), touched.end() );
+      for ( auto const& u : touched )
+      {
+        if ( !locked[u] )
+        {
+          ++version[u];
+          push( u );
+        }
+      }
+    }
+
+    /* roll back the moves after the best cut */
+    while ( moves.size() > best_prefix )
+    {
+      auto const [v, from] = moves.back();
+      moves.pop_back();
+      move( v, from, nullptr );
+    }
+    assert( km1 == best_km1 );
+    st.num_moves += best_prefix;
+  }
+
+private:
+  partition_view const& aig_p;
+  native_partition_params const& ps;
+  native_partition_stats& st;
+
+  uint32_t const num_vertices;
+  uint32_t const num_edges;
+  uint32_t const k;
+  std::vector<size_t> const& indices;
+  std::vector<mt_kahypar_hyperedge_id_t> const& pins;
+  std::vector<int64_t> edge_weight;
+  std::vector<int64_t> vertex_weight;
+  std::vector<uint32_t> vertex_indices;
+  std::vector<uint32_t> vertex_edges;
+
+  std::vector<mt_kahypar_partition_id_t> part;
+  std::vector<int64_t> block_weight;
+  int64_t max_block_weight{ 0 };
+  std::vector<uint32_t> pin_count;
+  int64_t km1{ 0 };
+
+  std::vector<int64_t> connected;
+  std::vector<uint32_t> version;
+  std::vector<uint8_t> locked;
+};
+
+} // namespace detail
+
+/*! \brief Partitions the hypergraph of a partition view without mt-KaHyPar.
+ *
+ * A lightweight alternative to mt-KaHyPar for small and medium networks,
+ * where a multilevel partitioner (and its thread pool) costs more than it
+ * gains.  The hypernodes are ordered topologically, every source right
+ * before its first reader, and cut into `num_blocks` chunks of equal
+ * weight.  The chunks are then refined by k-way Fiduccia-Mattheyses
+ * passes on the connectivity (km1) objective, which move one hypernode
+ * at a time to the adjacent block with the highest gain as long as the
+ * block stays below `(1 + epsilon)` times the average weight, and roll
+ * back to the best cut seen in the pass.
+ *
+ * Uses the number of blocks, imbalance and weights of the view's
+ * parameters and returns the dense node-to-block vector, which can be
+ * passed to `construct_from_partition`.  The memory is linear in the
+ * number of pins plus hyperedges times blocks.
+ */
+inline std::vector<partition_view::block_id> native_partition( partition_view const& aig_p, native_partition_params const& ps = {}, native_partition_stats* pst = nullptr )
+{
+  native_partition_stats st;
+  detail::native_partition_impl p( aig_p, ps, st );
+  auto const node_block = p.run();
+
+  if ( ps.verbose )
+  {
+    st.report();
+  }
+  if ( pst )
+  {
+    *pst = st;
+  }
+  return node_block;
+}
+
+} // namespace mockturtle
@@ -0,0 +1,88 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file partition_equivalence_checking.hpp
+  \brief Block-wise equivalence checking of partitioned networks
+*/
+
+#pragma once
+
+#include "../networks/aig.hpp"
+#include "../utils/parallel_utils.hpp"
+#include "../views/partition_view.hpp"
+#include "equivalence_checking.hpp"
+#include "miter.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace mockturtle
+{
+
+/*! \brief Checks the optimized logic of a block against its original logic.
+ *
+ * Both networks must have the interface of the block, i.e., the same
+ * PIs and POs in the same order.  Returns `std::nullopt` if the
+ * interfaces differ or the SAT solver hits its resource limit.
+ */
+inline std::optional<bool> block_equivalence_checking( aig_network const& original, aig_network const& optimized, equivalence_checking_params const& ps = {} )
+{
+  auto const m = miter<aig_network>( original, optimized );
+  if ( !m )
+  {
+    return std::nullopt;
+  }
+  return equivalence_checking( *m, ps );
+}
+
+/*! \brief Partition-local equivalence checking.
+ *
+ * Instead of checking the whole reunited network, checks every block in
+ * `blocks` with a miter of its original logic (`original`, as returned by
+ * `construct_from_partition`) and its replacement (`optimized`, same
+ * order).  Blocks which were not modified do not need to be listed.  The
+ * miters are checked concurrently on `num_threads` threads (0: all
+ * hardware threads).  Since every block is checked with its boundary as
+ * free inputs, the reunited network is equivalent to the original one if
+ * all listed blocks are.
+ *
+ * Returns the result of `block_equivalence_checking` of every listed
+ * block, in the order of `blocks`.
+ */
+inline std::vector<std::optional<bool>> partition_equivalence_checking( std::vector<partition_view::aig_part> const& original, std::vector<partition_view::aig_part> const& optimized,
+                                                                        std::vector<uint32_t> const& blocks, uint32_t num_threads = 0u, equivalence_checking_params const& ps = {} )
+{
+  assert( original.size() == optimized.size() );
+  std::vector<std::optional<bool>> result( blocks.size() );
+  parallel_for( static_cast<uint32_t>( blocks.size() ), num_threads, [&]( uint32_t i, uint32_t ) {
+    result[i] = block_equivalence_checking( std::get<0>( original[blocks[i]] ), std::get<0>( optimized[blocks[i]] ), ps );
+  } );
+  return result;
+}
+
+} // namespace mockturtle
@@ -0,0 +1,569 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file partition_optimization.hpp
+  \brief Split-optimize-reunite driver on top of partition_view
+*/
+
+#pragma once
+
+#include "../io/aiger_reader.hpp"
+#include "../io/write_aiger.hpp"
+#include "../networks/aig.hpp"
+#include "../utils/node_map.hpp"
+#include "../utils/parallel_utils.hpp"
+#include "../utils/process_utils.hpp"
+#include "../utils/stopwatch.hpp"
+#include "../views/partition_view.hpp"
+#include "boundary_refinement.hpp"
+#include "cleanup.hpp"
+#include "partition_equivalence_checking.hpp"
+
+#include <fmt/format.h>
+#include <lorina/aiger.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mockturtle
+{
+
+struct partition_optimization_params
+{
+  /*! \brief Number of threads (or processes) optimizing blocks (0: all hardware threads).
+   *
+   * Only the optimization of the blocks uses this number.  Their
+   * extraction and reunion run on `partition_view_params::num_threads` of
+   * the partition view, which the views of the hierarchy levels inherit.
+   */
+  uint32_t num_threads{ 0u };
+
+  /*! \brief Optimize every block in a forked worker process (see `run_in_processes`).
+   *
+   * A crash or timeout of a script only loses the optimization of its
+   * block, which keeps its original logic.
+   */
+  bool use_processes{ false };
+
+  /*! \brief Seconds after which a worker process is killed (0: no limit). */
+  double block_timeout{ 0.0 };
+
+  /*! \brief Shared memory per worker process for the optimized block in AIGER format. */
+  uint64_t process_buffer_size{ 64u << 20 };
+
+  /*! \brief Number of partition tree levels above the leaves which are
+   * merged and optimized again (hierarchical reunion). */
+  uint32_t hierarchy_levels{ 0u };
+
+  /*! \brief Refine the partition towards fewer block inputs and outputs
+   * before extracting the blocks (see `boundary_refinement`). */
+  bool refine_boundaries{ false };
+
+  /*! \brief Check every improved block against its original logic (per-block
+   * miter) and keep the original logic unless they are proven equivalent. */
+  bool verify{ false };
+
+  /*! \brief Conflict limit of the SAT solver when verifying a block (0: no limit). */
+  uint32_t verify_conflict_limit{ 0u };
+
+  /*! \brief Be verbose. */
+  bool verbose{ false };
+};
+
+struct partition_optimization_stats
+{
+  /*! \brief Total runtime. */
+  stopwatch<>::duration time_total{ 0 };
+
+  /*! \brief Runtime of the boundary refinement. */
+  stopwatch<>::duration time_refine{ 0 };
+
+  /*! \brief Block inputs plus outputs removed by the boundary refinement. */
+  int64_t boundary_reduction{ 0 };
+
+  /*! \brief Runtime of the block extraction. */
+  stopwatch<>::duration time_extract{ 0 };
+
+  /*! \brief Runtime of the block optimization (wall time). */
+  stopwatch<>::duration time_optimize{ 0 };
+
+  /*! \brief Runtime of the reunion. */
+  stopwatch<>::duration time_reunite{ 0 };
+
+  /*! \brief Number of optimized blocks (over all levels). */
+  uint32_t num_blocks{ 0u };
+
+  /*! \brief Number of blocks whose optimized logic was kept. */
+  uint32_t num_improved{ 0u };
+
+  /*! \brief Number of improved blocks dropped by the reunion (cycles). */
+  uint32_t num_rejected{ 0u };
+
+  /*! \brief Number of improved blocks dropped since their equivalence was not proven. */
+  uint32_t num_unverified{ 0u };
+
+  /*! \brief Number of blocks whose worker process crashed or overflowed its buffer. */
+  uint32_t num_failed{ 0u };
+
+  /*! \brief Number of blocks whose worker process was killed after `block_timeout`. */
+  uint32_t num_timeouts{ 0u };
+
+  void report() const
+  {
+    std::cout << fmt::format( "[i] blocks           = {:>5} ({} improved, {} rejected, {} unverified)\n", num_blocks, num_improved, num_rejected, num_unverified );
+    if ( num_failed + num_timeouts > 0u )
+    {
+      std::cout << fmt::format( "[i] lost workers     = {:>5} ({} failed, {} timed out)\n", num_failed + num_timeouts, num_failed, num_timeouts );
+    }
+    std::cout << fmt::format( "[i] refine time      = {:>5.2f} secs ({} boundary signals removed)\n", to_seconds( time_refine ), boundary_reduction );
+    std::cout << fmt::format( "[i] extract time     = {:>5.2f} secs\n", to_seconds( time_extract ) );
+    std::cout << fmt::format( "[i] optimize time    = {:>5.2f} secs\n", to_seconds( time_optimize ) );
+    std::cout << fmt::format( "[i] reunite time     = {:>5.2f} secs\n", to_seconds( time_reunite ) );
+    std::cout << fmt::format( "[i] total time       = {:>5.2f} secs\n", to_seconds( time_total ) );
+  }
+};
+
+/*! \brief Optimization script applied to a single block, modifies the network in place. */
+using block_script_t = std::function<void( aig_network& )>;
+
+/*! \brief Cost of a block, smaller is better. */
+using block_cost_fn_t = std::function<uint32_t( aig_network const& )>;
+
+inline uint32_t block_size_cost( aig_network const& ntk )
+{
+  return ntk.num_gates();
+}
+
+/*! \brief Split-optimize-reunite engine.
+ *
+ * The network of a `partition_view` is split into its blocks, all scripts
+ * are run (in the order they were added) on every block concurrently, and
+ * the blocks are reunited into one network.  The optimized logic of a
+ * block is kept only if its cost improved, otherwise the block keeps its
+ * original logic.
+ *
+ * Blocks are handed out to the worker threads dynamically, largest blocks
+ * first, so that idle workers pick up the remaining blocks while a large
+ * one is still being optimized.  Scripts are called from several threads
+ * at the same time and must not share mutable state.
+ *
+ * With `verify`, every improved block is checked against its original
+ * logic on the same thread right after optimizing it, so only modified
+ * blocks are verified and the checks run in parallel.
+ *
+ * With `use_processes`, every block is optimized (and verified) in a
+ * forked worker process instead of a thread, which sends the improved
+ * block back as a binary AIGER buffer over shared memory.  Blocks whose
+ * worker crashes, exceeds `block_timeout` or overflows its buffer keep
+ * their original logic, the others are reunited as usual.
+ *
+ * **Example**
+ *
+   \verbatim embed:rst
+
+   .. code-block:: c++
+
+      partition_optimization_stats st;
+      partition_optimizer opt( {}, st );
+      opt.add_script( []( aig_network& ntk ) { ntk = balancing( ntk, { sop_rebalancing<aig_network>{} } ); } );
+      opt.add_script( []( aig_network& ntk ) { aig_resubstitution( ntk ); ntk = cleanup_dangling( ntk ); } );
+      aig_network res = opt.run( aig_p, node_block );
+   \endverbatim
+ */
+class partition_optimizer
+{
+public:
+  using block_id = partition_view::block_id;
+
+  partition_optimizer( partition_optimization_params const& ps, partition_optimization_stats& st, block_cost_fn_t const& cost_fn = block_size_cost )
+      : _ps( ps ), _st( st ), cost( cost_fn )
+  {
+  }
+
+  void add_script( block_script_t const& script )
+  {
+    scripts.emplace_back( script );
+  }
+
+  /*! \brief Optimizes all blocks of `node_block` (dense node-to-block vector).
+   *
+   * If `node_origin` is given, it receives the block every node of the
+   * result was created from, which can seed the partition of the next
+   * round (see `partition_view::improve_partition`).
+   */
+  aig_network run( partition_view& aig_p, std::vector<block_id> const& node_block, std::vector<block_id>* node_origin = nullptr )
+  {
+    stopwatch t( _st.time_total );
+    if ( _ps.refine_boundaries )
+    {
+      boundary_refinement_stats br_st;
+      auto const refined = call_with_stopwatch( _st.time_refine, [&]() {
+        return boundary_refinement( aig_p, node_block, {}, &br_st );
+      } );
+      _st.boundary_reduction += br_st.initial_boundary - br_st.boundary;
+      return optimize_blocks( aig_p, refined, node_origin );
+    }
+    return optimize_blocks( aig_p, node_block, node_origin );
+  }
+
+  /*! \brief Optimizes the leaves of a partition tree, then its upper levels.
+   *
+   * After the leaf blocks are optimized and reunited, the subtrees of
+   * height 1, 2, ..., `hierarchy_levels` are merged into single blocks of
+   * the reunited network and optimized again, which lets the scripts work
+   * across the boundaries of the smaller blocks.
+   */
+  aig_network run( partition_view& aig_p, partition_view::partition_tree const& tree )
+  {
+    stopwatch t( _st.time_total );
+
+    /* leaf block of every node in the current network */
+    std::vector<block_id> origin;
+    auto res = optimize_blocks( aig_p, tree.node_block, &origin );
+
+    auto const max_height = std::min( _ps.hierarchy_levels, tree.nodes[0].height );
+    for ( auto height = 1u; height <= max_height; ++height )
+    {
+      uint32_t num_merged;
+      auto const merged = tree.merge_leaves( height, num_merged );
+
+      /* a leaf representing every merged block keeps track of the origins */
+      std::vector<block_id> representative( num_merged, -1 );
+      for ( auto b = 0u; b < merged.size(); ++b )
+      {
+        if ( representative[merged[b]] == -1 )
+        {
+          representative[merged[b]] = b;
+        }
+      }
+
+      std::vector<block_id> node_block( res.size(), 0 );
+      node_block[0] = -1;
+      res.foreach_gate( [&]( auto const& n ) {
+        node_block[n] = merged[origin[n]];
+      } );
+
+      /* the view of a level must not overwrite the hypergraph files of the leaves */
+      auto level_ps = aig_p.params();
+      level_ps.write_hmetis = false;
+      level_ps.write_csr = false;
+      partition_view level_p{ res, level_ps };
+      res = optimize_blocks( level_p, node_block, &origin );
+      std::for_each( origin.begin(), origin.end(), [&]( auto& b ) {
+        b = b == -1 ? -1 : representative[b];
+      } );
+    }
+    return res;
+  }
+
+private:
+  aig_network optimize_blocks( partition_view& aig_p, std::vector<block_id> const& node_block, std::vector<block_id>* node_origin )
+  {
+    auto const num_blocks = static_cast<uint32_t>( *std::max_element( node_block.begin(), node_block.end() ) + 1 );
+    _st.num_blocks += num_blocks;
+
+    auto parts = call_with_stopwatch( _st.time_extract, [&]() {
+      return aig_p.construct_from_partition( num_blocks, node_block );
+    } );
+
+    /* largest blocks first */
+    std::vector<uint32_t> order( num_blocks );
+    std::iota( order.begin(), order.end(), 0u );
+    std::stable_sort( order.begin(), order.end(), [&]( auto const& a, auto const& b ) {
+      return std::get<3>( parts[a] ).size() > std::get<3>( parts[b] ).size();
+    } );
+
+    std::vector<block_result> improved( num_blocks, block_result::unchanged );
+    call_with_stopwatch( _st.time_optimize, [&]() {
+      if ( _ps.use_processes )
+      {
+        optimize_in_processes( aig_p, parts, order, improved );
+        return;
+      }
+      parallel_for( num_blocks, _ps.num_threads, [&]( uint32_t i, uint32_t ) {
+        auto& part = parts[order[i]];
+        improved[order[i]] = optimize_block( order[i], std::get<0>( part ), aig_p.halo_nodes( order[i] ), std::get<2>( part ).size() );
+      } );
+    } );
+    auto const num_improved = static_cast<uint32_t>( std::count( improved.begin(), improved.end(), block_result::improved ) );
+    _st.num_improved += num_improved;
+    _st.num_unverified += static_cast<uint32_t>( std::count( improved.begin(), improved.end(), block_result::unverified ) );
+
+    auto res = call_with_stopwatch( _st.time_reunite, [&]() {
+      return aig_p.reunite( parts, node_origin );
+    } );
+    _st.num_rejected += aig_p.rejected_blocks().size();
+
+    if ( _ps.verbose )
+    {
+      fmt::print( "[i] kept {} of {} optimized blocks, {} rejected by the reunion\n", num_improved, num_blocks, aig_p.rejected_blocks().size() );
+    }
+    return res;
+  }
+
+  enum class block_result : uint8_t
+  {
+    unchanged,
+    improved,
+    unverified
+  };
+
+  /* optimizes every block in a worker process, improved blocks come back in AIGER format */
+  void optimize_in_processes( partition_view const& aig_p, std::vector<partition_view::aig_part>& parts, std::vector<uint32_t> const& order, std::vector<block_result>& improved )
+  {
+    run_in_processes(
+        static_cast<uint32_t>( order.size() ), _ps.num_threads, _ps.block_timeout, _ps.process_buffer_size,
+        [&]( uint32_t i, std::string& result ) {
+          auto& ntk = std::get<0>( parts[order[i]] );
+          auto const r = optimize_block( order[i], ntk, aig_p.halo_nodes( order[i] ), std::get<2>( parts[order[i]] ).size() );
+          result.push_back( static_cast<char>( r ) );
+          if ( r == block_result::improved )
+          {
+            std::ostringstream os;
+            /* halo nodes must keep their index */
+            write_aiger( aig_p.halo_nodes( order[i] ).empty() ? cleanup_dangling( ntk ) : ntk, os );
+            result += os.str();
+          }
+        },
+        [&]( uint32_t i, process_status status, char const* data, size_t size ) {
+          auto const block = order[i];
+          if ( status == process_status::success && size > 0u )
+          {
+            improved[block] = static_cast<block_result>( data[0] );
+            if ( improved[block] != block_result::improved )
+            {
+              return;
+            }
+            aig_network ntk;
+            std::istringstream is( std::string( data + 1, size - 1u ) );
+            if ( lorina::read_aiger( is, aiger_reader( ntk ) ) == lorina::return_code::success )
+            {
+              std::get<0>( parts[block] ) = ntk;
+              return;
+            }
+            improved[block] = block_result::unchanged;
+          }
+
+          ++( status == process_status::timeout ? _st.num_timeouts : _st.num_failed );
+          if ( _ps.verbose )
+          {
+            fmt::print( "[w] worker of block {} {}, keeping the original logic\n", block,
+                        status == process_status::timeout ? "timed out" : ( status == process_status::overflow ? "overflowed its buffer" : "failed" ) );
+          }
+        } );
+  }
+
+  /* replaces `ntk` by its optimized version if the cost improved (and it is proven equivalent)
+   *
+   * Blocks with halo gates are compared by `own_gates` instead of the cost
+   * function, since the halo is owned by other blocks.
+   */
+  block_result optimize_block( uint32_t block, aig_network& ntk, std::vector<uint32_t> const& halo, size_t num_outputs ) const
+  {
+    auto const cost_before = halo.empty() ? cost( ntk ) : own_gates( ntk, halo, num_outputs );
+    auto opt = ntk.clone();
+    for ( auto const& script : scripts )
+    {
+      script( opt );
+    }
+
+    /* the block interface must be preserved */
+    if ( opt.num_pis() != ntk.num_pis() || opt.num_pos() != ntk.num_pos() )
+    {
+      if ( _ps.verbose )
+      {
+        fmt::print( "[w] block {} changed its interface, keeping the original logic\n", block );
+      }
+      return block_result::unchanged;
+    }
+
+    if ( !halo.empty() )
+    {
+      opt = anchor_to_window( ntk, opt, num_outputs );
+    }
+    auto const cost_after = halo.empty() ? cost( opt ) : own_gates( opt, halo, num_outputs );
+    if ( _ps.verbose )
+    {
+      fmt::print( "[i] block {}: cost {} -> {}\n", block, cost_before, cost_after );
+    }
+    if ( cost_after >= cost_before )
+    {
+      return block_result::unchanged;
+    }
+
+    if ( _ps.verify )
+    {
+      equivalence_checking_params ec_ps;
+      ec_ps.conflict_limit = _ps.verify_conflict_limit;
+      if ( block_equivalence_checking( ntk, opt, ec_ps ) != std::optional<bool>( true ) )
+      {
+        if ( _ps.verbose )
+        {
+          fmt::print( "[w] block {} could not be verified, keeping the original logic\n", block );
+        }
+        return block_result::unverified;
+      }
+    }
+    ntk = opt;
+    return block_result::improved;
+  }
+
+  /* copy of the window `orig` whose first `num_outputs` POs are taken from `opt`
+   *
+   * All nodes of `orig` keep their index, so that the reunion can take the
+   * halo nodes from the neighbouring blocks.  Structurally unchanged logic
+   * of `opt` merges with them.
+   */
+  static aig_network anchor_to_window( aig_network const& orig, aig_network const& opt, size_t num_outputs )
+  {
+    aig_network win;
+    unordered_node_map<aig_network::signal, aig_network> orig_to_new( orig );
+    orig_to_new[orig.get_constant( false )] = win.get_constant( false );
+    orig.foreach_pi( [&]( auto const& n ) {
+      orig_to_new[n] = win.create_pi();
+    } );
+    orig.foreach_gate( [&]( auto const& n ) {
+      copy_cone( orig, orig.make_signal( n ), win, orig_to_new );
+    } );
+    assert( win.size() == orig.size() );
+
+    unordered_node_map<aig_network::signal, aig_network> opt_to_new( opt );
+    opt_to_new[opt.get_constant( false )] = win.get_constant( false );
+    opt.foreach_pi( [&]( auto const& n, auto i ) {
+      opt_to_new[n] = win.make_signal( win.pi_at( i ) );
+    } );
+    std::vector<aig_network::signal> pos;
+    orig.foreach_po( [&]( auto const& f, auto i ) {
+      pos.push_back( i < num_outputs ? copy_cone( opt, opt.po_at( i ), win, opt_to_new ) : copy_cone( orig, f, win, orig_to_new ) );
+    } );
+    for ( auto const& f : pos )
+    {
+      win.create_po( f );
+    }
+    return win;
+  }
+
+  /* number of gates in the cones of the first `num_outputs` POs, without the `halo` nodes */
+  static uint32_t own_gates( aig_network const& ntk, std::vector<uint32_t> const& halo, size_t num_outputs )
+  {
+    std::vector<uint8_t> visited( ntk.size(), 0u );
+    for ( auto const& n : halo )
+    {
+      visited[n] = 1u;
+    }
+    uint32_t num_gates = 0u;
+    std::vector<aig_network::node> stack;
+    for ( auto i = 0u; i < num_outputs; ++i )
+    {
+      stack.push_back( ntk.get_node( ntk.po_at( i ) ) );
+      while ( !stack.empty() )
+      {
+        auto const n = stack.back();
+        stack.pop_back();
+        if ( visited[n] || !ntk.is_and( n ) )
+        {
+          continue;
+        }
+        visited[n] = 1u;
+        ++num_gates;
+        ntk.foreach_fanin( n, [&]( auto const& fi ) {
+          stack.push_back( ntk.get_node( fi ) );
+        } );
+      }
+    }
+    return num_gates;
+  }
+
+  /* copies the cone of `f` in `ntk` into `win` (iterative, cones can be deep) */
+  static aig_network::signal copy_cone( aig_network const& ntk, aig_network::signal const& f, aig_network& win, unordered_node_map<aig_network::signal, aig_network>& old_to_new )
+  {
+    std::vector<aig_network::node> stack{ ntk.get_node( f ) };
+    while ( !stack.empty() )
+    {
+      auto const n = stack.back();
+      if ( old_to_new.has( n ) )
+      {
+        stack.pop_back();
+        continue;
+      }
+      bool ready = true;
+      ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        if ( !old_to_new.has( ntk.get_node( fi ) ) )
+        {
+          stack.push_back( ntk.get_node( fi ) );
+          ready = false;
+        }
+      } );
+      if ( ready )
+      {
+        std::array<aig_network::signal, 2u> fs;
+        ntk.foreach_fanin( n, [&]( auto const& fi, auto i ) {
+          fs[i] = old_to_new[ntk.get_node( fi )] ^ ntk.is_complemented( fi );
+        } );
+        old_to_new[n] = win.create_and( fs[0], fs[1] );
+        stack.pop_back();
+      }
+    }
+    return old_to_new[ntk.get_node( f )] ^ ntk.is_complemented( f );
+  }
+
+private:
+  const partition_optimization_params _ps;
+  partition_optimization_stats& _st;
+  block_cost_fn_t cost;
+  std::vector<block_script_t> scripts;
+};
+
+/*! \brief Runs `script` on every block of `node_block` and reunites the blocks.
+ *
+ * Convenience wrapper around `partition_optimizer` with a single script.
+ */
+inline aig_network partition_optimization( partition_view& aig_p, std::vector<partition_view::block_id> const& node_block, block_script_t const& script,
+                                           partition_optimization_params const& ps = {}, partition_optimization_stats* pst = nullptr )
+{
+  partition_optimization_stats st;
+  partition_optimizer opt( ps, st );
+  opt.add_script( script );
+  auto res = opt.run( aig_p, node_block );
+
+  if ( ps.verbose )
+  {
+    st.report();
+  }
+  if ( pst )
+  {
+    *pst = st;
+  }
+  return res;
+}
+
+} // namespace mockturtle
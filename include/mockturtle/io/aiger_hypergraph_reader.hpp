@@ -0,0 +1,170 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file aiger_hypergraph_reader.hpp
+  \brief Lorina reader for the hypergraph of an AIGER file
+*/
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include <lorina/aiger.hpp>
+
+#include "hypergraph_csr.hpp"
+
+namespace mockturtle
+{
+
+/*! \brief Lorina reader callback for the hypergraph of an AIGER file.
+ *
+ * Builds the hypergraph of `partition_view` directly from the file,
+ * without building the network: every variable read by an AND gate has
+ * a hyperedge with the variable itself followed by the gates reading it,
+ * weighted by the number of these gates, and variable `v` is hypernode
+ * `v - 1` (the constant, if it is read, is the last hypernode).  Vertex
+ * weights are not set.
+ *
+ * Only the fanins of the AND gates and the number of readers of every
+ * variable are kept while reading; the CSR arrays are filled once the
+ * last AND gate is read, so `hg` is left untouched if the file ends
+ * early or an AND gate cannot be parsed.  Designs which do not fit into memory as an
+ * `aig_network` together with the hypergraph can be partitioned first
+ * and loaded afterwards.
+ *
+ * The hypernodes are the nodes of the `aig_network` read from the same
+ * file if the file has no trivial or structurally equal AND gates, e.g.,
+ * if it was written from a structurally hashed network; then
+ * `partition_view::node_to_block` maps the partition to the nodes.
+ * Latches are not supported.
+ *
+ * **Example**
+ *
+   \verbatim embed:rst
+
+   .. code-block:: c++
+
+      hypergraph_csr hg;
+      lorina::read_aiger( "file.aig", aiger_hypergraph_reader( hg ) );
+   \endverbatim
+ */
+class aiger_hypergraph_reader : public lorina::aiger_reader
+{
+public:
+  explicit aiger_hypergraph_reader( hypergraph_csr& hg )
+      : _hg( hg )
+  {
+  }
+
+  void on_header( uint64_t m, uint64_t i, uint64_t l, uint64_t, uint64_t a ) const override
+  {
+    (void)l;
+    assert( l == 0u && "latches are not supported" );
+    _num_inputs = i;
+    _num_ands = a;
+    _num_readers.assign( m + 1u, 0u );
+    _fanins.reserve( 2u * a );
+    if ( a == 0u )
+    {
+      build_csr();
+    }
+  }
+
+  void on_and( uint32_t index, uint32_t left_lit, uint32_t right_lit ) const override
+  {
+    (void)index;
+    assert( index == _num_inputs + 1u + _fanins.size() / 2u );
+    _fanins.push_back( left_lit >> 1 );
+    _fanins.push_back( right_lit >> 1 );
+    ++_num_readers[left_lit >> 1];
+    ++_num_readers[right_lit >> 1];
+    if ( _fanins.size() == 2u * _num_ands )
+    {
+      build_csr();
+    }
+  }
+
+private:
+  void build_csr() const
+  {
+    auto const num_vars = _num_inputs + 1u + _fanins.size() / 2u;
+    assert( num_vars <= _num_readers.size() );
+
+    /* offsets, the constant goes last */
+    _hg.num_vertices = num_vars - 1u;
+    _hg.indices.assign( 1u, 0u );
+    _hg.hyperedge_weights.clear();
+    _hg.vertex_weights.clear();
+    std::vector<uint64_t> cursor( num_vars, 0u );
+    auto add_offset = [&]( uint64_t v ) {
+      if ( _num_readers[v] == 0u )
+      {
+        return;
+      }
+      cursor[v] = _hg.indices.back() + 1u;
+      _hg.indices.push_back( _hg.indices.back() + 1u + _num_readers[v] );
+      _hg.hyperedge_weights.push_back( static_cast<int32_t>( _num_readers[v] ) );
+    };
+    for ( auto v = 1u; v < num_vars; ++v )
+    {
+      add_offset( v );
+    }
+    add_offset( 0u );
+
+    /* pins */
+    _hg.pins.resize( _hg.indices.back() );
+    for ( auto v = 0u; v < num_vars; ++v )
+    {
+      if ( _num_readers[v] > 0u )
+      {
+        _hg.pins[cursor[v] - 1u] = v == 0u ? _hg.num_vertices : v - 1u;
+      }
+    }
+    for ( auto j = 0u; j < _fanins.size(); ++j )
+    {
+      _hg.pins[cursor[_fanins[j]]++] = _num_inputs + j / 2u;
+    }
+
+    if ( _num_readers[0] > 0u )
+    {
+      ++_hg.num_vertices;
+    }
+    _fanins = {};
+    _num_readers = {};
+  }
+
+private:
+  hypergraph_csr& _hg;
+
+  mutable uint64_t _num_inputs{ 0u };
+  mutable uint64_t _num_ands{ 0u };
+  mutable std::vector<uint32_t> _fanins;
+  mutable std::vector<uint32_t> _num_readers;
+};
+
+} // namespace mockturtle
@@ -0,0 +1,178 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file hypergraph_csr.hpp
+  \brief Binary CSR format of hypergraphs
+*/
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mockturtle
+{
+
+/*! \brief Hypergraph in compressed sparse row format.
+ *
+ * Hyperedge `e` has the (zero-based) hypernodes `pins[indices[e]]` to
+ * `pins[indices[e + 1] - 1]`.  Weights are empty if not used.
+ */
+struct hypergraph_csr
+{
+  uint64_t num_vertices{ 0u };
+  std::vector<uint64_t> indices{ 0u };
+  std::vector<uint64_t> pins;
+  std::vector<int32_t> hyperedge_weights;
+  std::vector<int32_t> vertex_weights;
+
+  uint64_t num_hyperedges() const
+  {
+    return indices.size() - 1u;
+  }
+};
+
+/*! \brief Header of a binary hypergraph CSR file.
+ *
+ * The header is followed by `num_hyperedges + 1` indices and `num_pins`
+ * pins (64-bit each), then by `num_hyperedges` hyperedge weights if
+ * `flags & 1` and `num_vertices` vertex weights if `flags & 2` (32-bit
+ * each).  All values are in native byte order and every section is
+ * aligned to its element size, so the file can be memory-mapped and the
+ * sections used in place.
+ */
+struct hypergraph_csr_header
+{
+  char magic[4];
+  uint32_t version;
+  uint64_t num_vertices;
+  uint64_t num_hyperedges;
+  uint64_t num_pins;
+  uint32_t flags;
+  uint32_t reserved;
+};
+
+namespace detail
+{
+
+constexpr char hypergraph_csr_magic[4] = { 'S', 'R', 'H', 'G' };
+constexpr uint32_t hypergraph_csr_version = 1u;
+
+/* writes `data` as an array of `To`, converting in chunks if the types differ */
+template<typename To, typename From>
+void write_csr_array( std::ostream& os, std::vector<From> const& data )
+{
+  if constexpr ( sizeof( To ) == sizeof( From ) )
+  {
+    os.write( reinterpret_cast<char const*>( data.data() ), data.size() * sizeof( From ) );
+  }
+  else
+  {
+    std::vector<To> chunk;
+    chunk.reserve( 1u << 16 );
+    for ( auto i = 0u; i < data.size(); i += chunk.capacity() )
+    {
+      chunk.clear();
+      for ( auto j = i; j < data.size() && chunk.size() < chunk.capacity(); ++j )
+      {
+        chunk.push_back( static_cast<To>( data[j] ) );
+      }
+      os.write( reinterpret_cast<char const*>( chunk.data() ), chunk.size() * sizeof( To ) );
+    }
+  }
+}
+
+template<typename T>
+bool read_csr_array( std::istream& is, std::vector<T>& data, uint64_t size )
+{
+  data.resize( size );
+  is.read( reinterpret_cast<char*>( data.data() ), size * sizeof( T ) );
+  return static_cast<bool>( is );
+}
+
+} // namespace detail
+
+/*! \brief Writes a hypergraph in binary CSR format.
+ *
+ * `indices` and `pins` are integer vectors, the weight vectors may be
+ * empty if the hypergraph has no weights.  Returns false if the file
+ * cannot be written.
+ */
+template<typename Indices, typename Pins, typename EdgeWeights, typename VertexWeights>
+bool write_hypergraph_csr( std::string const& filename, uint64_t num_vertices, std::vector<Indices> const& indices, std::vector<Pins> const& pins,
+                           std::vector<EdgeWeights> const& hyperedge_weights, std::vector<VertexWeights> const& vertex_weights )
+{
+  static_assert( sizeof( hypergraph_csr_header ) == 40u );
+  assert( !indices.empty() && indices.back() == pins.size() );
+
+  hypergraph_csr_header header{};
+  std::memcpy( header.magic, detail::hypergraph_csr_magic, sizeof( header.magic ) );
+  header.version = detail::hypergraph_csr_version;
+  header.num_vertices = num_vertices;
+  header.num_hyperedges = indices.size() - 1u;
+  header.num_pins = pins.size();
+  header.flags = ( hyperedge_weights.empty() ? 0u : 1u ) | ( vertex_weights.empty() ? 0u : 2u );
+
+  std::ofstream os( filename, std::ofstream::binary | std::ofstream::trunc );
+  os.write( reinterpret_cast<char const*>( &header ), sizeof( header ) );
+  detail::write_csr_array<uint64_t>( os, indices );
+  detail::write_csr_array<uint64_t>( os, pins );
+  detail::write_csr_array<int32_t>( os, hyperedge_weights );
+  detail::write_csr_array<int32_t>( os, vertex_weights );
+  return static_cast<bool>( os );
+}
+
+/*! \brief Reads a hypergraph in binary CSR format, `std::nullopt` if the file is invalid. */
+inline std::optional<hypergraph_csr> read_hypergraph_csr( std::string const& filename )
+{
+  std::ifstream is( filename, std::ifstream::binary );
+  hypergraph_csr_header header;
+  if ( !is.read( reinterpret_cast<char*>( &header ), sizeof( header ) ) ||
+       std::memcmp( header.magic, detail::hypergraph_csr_magic, sizeof( header.magic ) ) != 0 ||
+       header.version != detail::hypergraph_csr_version )
+  {
+    return std::nullopt;
+  }
+
+  hypergraph_csr hg;
+  hg.num_vertices = header.num_vertices;
+  if ( !detail::read_csr_array( is, hg.indices, header.num_hyperedges + 1u ) ||
+       !detail::read_csr_array( is, hg.pins, header.num_pins ) ||
+       !detail::read_csr_array( is, hg.hyperedge_weights, ( header.flags & 1u ) ? header.num_hyperedges : 0u ) ||
+       !detail::read_csr_array( is, hg.vertex_weights, ( header.flags & 2u ) ? header.num_vertices : 0u ) ||
+       hg.indices.back() != header.num_pins )
+  {
+    return std::nullopt;
+  }
+  return hg;
+}
+
+} // namespace mockturtle
@@ -36,6 +36,11 @@
   debugging-purpose only.  It allows to store the current state of the
   network (including dangling and dead nodes), but does not guarantee
   platform-independence (use, e.g., `write_verilog` instead).
+
+  An archive starts with a magic word and a format version.  Version 2
+  stores the structural hash table as a `strash_table`.  Archives of
+  version 1, which have no header and store a `phmap::flat_hash_map`, are
+  still read; their hash table is converted on loading.
 */
 
 #pragma once
@@ -57,6 +62,12 @@ public:
   using node_type = typename aig_network::storage::element_type::node_type;
   using pointer_type = typename node_type::pointer_type;
 
+  /* hash table of version 1 archives */
+  using legacy_hash_type = phmap::flat_hash_map<node_type, uint64_t, aig_hash<node_type>>;
+
+  static constexpr uint64_t magic = UINT64_C( 0x524553474941544d ); /* "MTAIGSER" in little-endian byte order */
+  static constexpr uint64_t version = 2u;
+
 public:
   bool operator()( phmap::BinaryOutputArchive& os, uint64_t const& data ) const
   {
@@ -80,6 +91,18 @@ public:
     return ar_input.load( (char*)&ptr->data, sizeof( ptr->data ) );
   }
 
+  template<int PointerFieldSize>
+  bool operator()( phmap::BinaryOutputArchive& os, compact_node_pointer<PointerFieldSize> const& ptr ) const
+  {
+    return os.dump( (char*)&ptr.data, sizeof( ptr.data ) );
+  }
+
+  template<int PointerFieldSize>
+  bool operator()( phmap::BinaryInputArchive& ar_input, compact_node_pointer<PointerFieldSize>* ptr ) const
+  {
+    return ar_input.load( (char*)&ptr->data, sizeof( ptr->data ) );
+  }
+
   bool operator()( phmap::BinaryOutputArchive& os, cauint64_t const& data ) const
   {
     return os.dump( (char*)&data.n, sizeof( data.n ) );
@@ -90,8 +113,8 @@ public:
     return ar_input.load( (char*)&data->n, sizeof( data->n ) );
   }
 
-  template<int Fanin, int Size, int PointerFieldSize>
-  bool operator()( phmap::BinaryOutputArchive& os, regular_node<Fanin, Size, PointerFieldSize> const& n ) const
+  template<template<int, int, int> class Node, int Fanin, int Size, int PointerFieldSize>
+  bool operator()( phmap::BinaryOutputArchive& os, Node<Fanin, Size, PointerFieldSize> const& n ) const
   {
     uint64_t size = n.children.size();
     if ( !os.dump( (char*)&size, sizeof( uint64_t ) ) )
@@ -125,8 +148,8 @@ public:
     return true;
   }
 
-  template<int Fanin, int Size, int PointerFieldSize>
-  bool operator()( phmap::BinaryInputArchive& ar_input, const regular_node<Fanin, Size, PointerFieldSize>* n ) const
+  template<template<int, int, int> class Node, int Fanin, int Size, int PointerFieldSize>
+  bool operator()( phmap::BinaryInputArchive& ar_input, const Node<Fanin, Size, PointerFieldSize>* n ) const
   {
     uint64_t size;
     if ( !ar_input.load( (char*)&size, sizeof( uint64_t ) ) )
@@ -142,7 +165,7 @@ public:
       {
         return false;
       }
-      const_cast<regular_node<Fanin, Size, PointerFieldSize>*>( n )->children[i] = ptr;
+      const_cast<Node<Fanin, Size, PointerFieldSize>*>( n )->children[i] = ptr;
     }
 
     ar_input.load( (char*)&size, sizeof( uint64_t ) );
@@ -154,7 +177,7 @@ public:
       {
         return false;
       }
-      const_cast<regular_node<Fanin, Size, PointerFieldSize>*>( n )->data[i] = data;
+      const_cast<Node<Fanin, Size, PointerFieldSize>*>( n )->data[i] = data;
     }
 
     return true;
@@ -172,6 +195,12 @@ public:
 
   bool operator()( phmap::BinaryOutputArchive& os, aig_storage const& storage ) const
   {
+    /* header */
+    if ( !os.dump( (char*)&magic, sizeof( uint64_t ) ) || !os.dump( (char*)&version, sizeof( uint64_t ) ) )
+    {
+      return false;
+    }
+
     /* nodes */
     uint64_t size = storage.nodes.size();
     if ( !os.dump( (char*)&size, sizeof( uint64_t ) ) )
@@ -230,12 +259,23 @@ public:
 
   bool operator()( phmap::BinaryInputArchive& ar_input, aig_storage* storage ) const
   {
-    /* nodes */
+    /* header, version 1 archives start with the number of nodes */
     uint64_t size;
+    uint64_t archive_version = 1u;
     if ( !ar_input.load( (char*)&size, sizeof( uint64_t ) ) )
     {
       return false;
     }
+    if ( size == magic )
+    {
+      if ( !ar_input.load( (char*)&archive_version, sizeof( uint64_t ) ) || archive_version != version ||
+           !ar_input.load( (char*)&size, sizeof( uint64_t ) ) )
+      {
+        return false;
+      }
+    }
+
+    /* nodes */
     for ( uint64_t i = 0; i < size; ++i )
     {
       node_type n;
@@ -277,7 +317,20 @@ public:
     }
 
     /* hash */
-    if ( !storage->hash.load( ar_input ) )
+    if ( archive_version == 1u )
+    {
+      legacy_hash_type hash;
+      if ( !hash.load( ar_input ) )
+      {
+        return false;
+      }
+      storage->hash.reserve( hash.size() );
+      for ( auto const& [n, index] : hash )
+      {
+        storage->hash[n] = index;
+      }
+    }
+    else if ( !storage->hash.load( ar_input ) )
     {
       return false;
     }
@@ -84,10 +84,22 @@ struct aig_hash
   `data[0].h2`: Application-specific value
   `data[1].h1`: Visited flag
   `data[1].h2`: Is terminal node (PI or CI)
+
+  Nodes are structurally hashed in a `strash_table`, which limits the network
+  to 2^31 - 1 nodes.  If `MOCKTURTLE_COMPACT_STORAGE` is defined, the index
+  pointers are 32-bit wide (`compact_regular_node`), which shrinks a node
+  from 32 to 24 bytes.
 */
-using aig_storage = storage<regular_node<2, 2, 1>,
+#ifdef MOCKTURTLE_COMPACT_STORAGE
+using aig_node = compact_regular_node<2, 2, 1>;
+#else
+using aig_node = regular_node<2, 2, 1>;
+#endif
+
+using aig_storage = storage<aig_node,
                             empty_storage_data,
-                            aig_hash<regular_node<2, 2, 1>>>;
+                            aig_hash<aig_node>,
+                            strash_table<aig_node>>;
 
 class aig_network
 {
@@ -204,6 +216,7 @@ public:
 
   signal create_pi()
   {
+    _storage->check_capacity();
     const auto index = _storage->nodes.size();
     auto& node = _storage->nodes.emplace_back();
     node.children[0].data = node.children[1].data = _storage->inputs.size();
@@ -291,12 +304,12 @@ public:
       return { it->second, 0 };
     }
 
+    _storage->check_capacity();
     const auto index = _storage->nodes.size();
 
     if ( index >= .9 * _storage->nodes.capacity() )
     {
       _storage->nodes.reserve( static_cast<uint64_t>( 3.1415f * index ) );
-      _storage->hash.reserve( static_cast<uint64_t>( 3.1415f * index ) );
     }
 
     _storage->nodes.push_back( node );
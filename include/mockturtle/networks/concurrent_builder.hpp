@@ -0,0 +1,360 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file concurrent_builder.hpp
+  \brief Builds an AIG or XAG from several threads at once
+*/
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../utils/parallel_utils.hpp"
+#include "aig.hpp"
+#include "storage.hpp"
+#include "xag.hpp"
+
+namespace mockturtle
+{
+
+/*! \brief Parameters for concurrent_builder.
+ *
+ * The data structure `concurrent_builder_params` holds configurable
+ * parameters with default arguments for `concurrent_builder`.
+ */
+struct concurrent_builder_params
+{
+  /*! \brief Number of threads creating gates (0: number of hardware threads). */
+  uint32_t num_threads{ 0u };
+
+  /*! \brief Number of node slots a thread takes at once (a power of two). */
+  uint32_t chunk_size{ 4096u };
+
+  /*! \brief Number of independently locked parts of the strash table (a power of two). */
+  uint32_t num_stripes{ 64u };
+};
+
+/*! \brief Builds an AIG or XAG from several threads at once.
+ *
+ * `create_and` and `create_xor` may be called concurrently as long as
+ * every thread passes its own `thread_id` in `[0, num_threads)`, e.g., the
+ * one handed out by `parallel_for`.  Gates are structurally hashed in
+ * `num_stripes` `strash_table`s, each guarded by its own mutex and selected
+ * by a hash of the two fan-ins, so threads only wait for each other when
+ * they create gates in the same stripe.  Each thread fills its own chunk of
+ * `chunk_size` consecutive node slots and only locks to append a new chunk,
+ * so the indices of the builder are neither dense nor topologically ordered.
+ * Since the indices must fit into the literals of a `strash_table`, a gate
+ * whose slot would exceed 2^31 - 2 throws `std::length_error`.
+ *
+ * Once all threads are done, `finalize` returns a regular network with the
+ * given outputs, whose gates are numbered in depth-first order from the
+ * outputs; gates which do not reach an output are dropped.  The function
+ * and the number of gates do not depend on the schedule of the threads,
+ * the order of the gates may.
+ *
+ * **Example**
+ *
+   \verbatim embed:rst
+
+   .. code-block:: c++
+
+      concurrent_builder<aig_network> builder( ntk.num_pis(), ps );
+      std::vector<aig_network::signal> outputs( ntk.num_pos() );
+      parallel_for( ntk.num_pos(), ps.num_threads, [&]( uint32_t i, uint32_t thread_id ) {
+        outputs[i] = ...; // builder.create_and( a, b, thread_id ), ...
+      } );
+      aig_network res = builder.finalize( outputs );
+   \endverbatim
+ */
+template<class Ntk>
+class concurrent_builder
+{
+  static_assert( std::is_same_v<Ntk, aig_network> || std::is_same_v<Ntk, xag_network>, "Ntk is not an AIG or an XAG" );
+
+public:
+  using signal = typename Ntk::signal;
+  using node_type = typename Ntk::storage::element_type::node_type;
+
+  explicit concurrent_builder( uint32_t num_pis, concurrent_builder_params const& ps = {} )
+      : _num_pis( num_pis ),
+        _chunk_bits( num_bits( ps.chunk_size ) ),
+        _stripe_bits( num_bits( ps.num_stripes ) ),
+        _chunks( ( uint64_t( num_pis ) >> _chunk_bits ) + 1u ),
+        _stripes( uint64_t( 1 ) << _stripe_bits ),
+        _cursors( resolve_num_threads( ps.num_threads ) )
+  {
+    /* the constant and the PIs occupy the first chunks, which have no node slots */
+    assert( ( ps.chunk_size & ( ps.chunk_size - 1u ) ) == 0u && ( ps.num_stripes & ( ps.num_stripes - 1u ) ) == 0u );
+  }
+
+  uint32_t num_pis() const
+  {
+    return _num_pis;
+  }
+
+  uint32_t num_threads() const
+  {
+    return static_cast<uint32_t>( _cursors.size() );
+  }
+
+  signal get_constant( bool value ) const
+  {
+    return { 0u, value ? 1u : 0u };
+  }
+
+  signal pi_at( uint32_t index ) const
+  {
+    assert( index < _num_pis );
+    return { index + 1u, 0u };
+  }
+
+  signal create_and( signal a, signal b, uint32_t thread_id )
+  {
+    /* same normalization as `aig_network::create_and` and `xag_network::create_and` */
+    if ( a.index > b.index )
+    {
+      std::swap( a, b );
+    }
+    if ( a.index == b.index )
+    {
+      return a.complement == b.complement ? a : get_constant( false );
+    }
+    else if ( a.index == 0 )
+    {
+      return a.complement == false ? get_constant( false ) : b;
+    }
+    return create_node( a, b, thread_id );
+  }
+
+  signal create_or( signal const& a, signal const& b, uint32_t thread_id )
+  {
+    return !create_and( !a, !b, thread_id );
+  }
+
+  signal create_xor( signal a, signal b, uint32_t thread_id )
+  {
+    if constexpr ( std::is_same_v<Ntk, xag_network> )
+    {
+      /* same normalization as `xag_network::create_xor` */
+      if ( a.index < b.index )
+      {
+        std::swap( a, b );
+      }
+
+      bool f_compl = a.complement != b.complement;
+      a.complement = b.complement = false;
+
+      if ( a.index == b.index )
+      {
+        return get_constant( f_compl );
+      }
+      else if ( b.index == 0 )
+      {
+        return a ^ f_compl;
+      }
+      return create_node( a, b, thread_id ) ^ f_compl;
+    }
+    else
+    {
+      /* same decomposition as `aig_network::create_xor` */
+      const auto fcompl = a.complement ^ b.complement;
+      const auto c1 = create_and( +a, -b, thread_id );
+      const auto c2 = create_and( +b, -a, thread_id );
+      return create_and( !c1, !c2, thread_id ) ^ !fcompl;
+    }
+  }
+
+  /*! \brief Number of gates created so far (only exact while no thread creates gates). */
+  uint64_t num_gates() const
+  {
+    uint64_t num = 0u;
+    for ( auto const& s : _stripes )
+    {
+      num += s.table.size();
+    }
+    return num;
+  }
+
+  /*! \brief Builds the network with outputs `outputs`, must not run concurrently with gate creation. */
+  Ntk finalize( std::vector<signal> const& outputs ) const
+  {
+    Ntk res;
+    std::vector<signal> old_to_new( _chunks.size() << _chunk_bits, get_constant( false ) );
+    std::vector<bool> visited( old_to_new.size() );
+    for ( auto i = 0u; i < _num_pis; ++i )
+    {
+      old_to_new[i + 1u] = res.create_pi();
+      visited[i + 1u] = true;
+    }
+    visited[0] = true;
+
+    auto const map = [&]( signal const& f ) {
+      return old_to_new[f.index] ^ f.complement;
+    };
+
+    /* iterative post-order, a node is pushed again as `{ index, true }` once its fanins are queued */
+    std::vector<std::pair<uint64_t, bool>> stack;
+    for ( auto const& o : outputs )
+    {
+      stack.emplace_back( o.index, false );
+      while ( !stack.empty() )
+      {
+        auto const [index, expanded] = stack.back();
+        stack.pop_back();
+        if ( visited[index] )
+        {
+          continue;
+        }
+
+        auto const& n = node_at( index );
+        if ( !expanded )
+        {
+          stack.emplace_back( index, true );
+          stack.emplace_back( n.children[1].index, false );
+          stack.emplace_back( n.children[0].index, false );
+          continue;
+        }
+
+        signal const c0 = n.children[0];
+        signal const c1 = n.children[1];
+        if constexpr ( std::is_same_v<Ntk, xag_network> )
+        {
+          old_to_new[index] = c0.index > c1.index ? res.create_xor( map( c0 ), map( c1 ) ) : res.create_and( map( c0 ), map( c1 ) );
+        }
+        else
+        {
+          old_to_new[index] = res.create_and( map( c0 ), map( c1 ) );
+        }
+        visited[index] = true;
+      }
+      res.create_po( map( o ) );
+    }
+    return res;
+  }
+
+private:
+  /* largest node index, indices must fit into the 31-bit literals of a `strash_table` */
+  static constexpr uint64_t max_nodes = strash_table<node_type>::max_nodes - 1u;
+
+  struct alignas( 64 ) stripe
+  {
+    std::mutex mutex;
+    strash_table<node_type> table;
+  };
+
+  /* the chunk a thread currently fills, only touched by the thread */
+  struct alignas( 64 ) cursor
+  {
+    uint64_t next{ 0u };
+    uint64_t end{ 0u };
+    node_type* nodes{ nullptr };
+  };
+
+  static uint32_t num_bits( uint64_t value )
+  {
+    uint32_t bits = 0u;
+    while ( ( UINT64_C( 1 ) << bits ) < value )
+    {
+      ++bits;
+    }
+    return bits;
+  }
+
+  node_type const& node_at( uint64_t index ) const
+  {
+    return _chunks[index >> _chunk_bits][index & ( ( UINT64_C( 1 ) << _chunk_bits ) - 1u )];
+  }
+
+  /* splitmix64 finalizer; stripes must not correlate with the probe positions inside a table */
+  uint64_t stripe_of( signal const& a, signal const& b ) const
+  {
+    uint64_t z = ( ( 2u * a.index + a.complement ) << 32u ) | ( 2u * b.index + b.complement );
+    z = ( z ^ ( z >> 30 ) ) * UINT64_C( 0xbf58476d1ce4e5b9 );
+    z = ( z ^ ( z >> 27 ) ) * UINT64_C( 0x94d049bb133111eb );
+    return ( z ^ ( z >> 31 ) ) & ( ( UINT64_C( 1 ) << _stripe_bits ) - 1u );
+  }
+
+  /* stores `node` in the next slot of the thread's chunk, takes a new chunk if it is full */
+  uint64_t allocate( node_type const& node, uint32_t thread_id )
+  {
+    assert( thread_id < _cursors.size() );
+    auto& c = _cursors[thread_id];
+    if ( c.next == c.end )
+    {
+      auto chunk = std::make_unique<node_type[]>( UINT64_C( 1 ) << _chunk_bits );
+      c.nodes = chunk.get();
+
+      std::lock_guard<std::mutex> lock( _chunks_mutex );
+      c.next = _chunks.size() << _chunk_bits;
+      c.end = c.next + ( UINT64_C( 1 ) << _chunk_bits );
+      _chunks.push_back( std::move( chunk ) );
+    }
+    if ( c.next > max_nodes )
+    {
+      throw std::length_error( "concurrent_builder exceeds the maximum number of nodes of a strash_table" );
+    }
+    c.nodes[c.next & ( ( UINT64_C( 1 ) << _chunk_bits ) - 1u )] = node;
+    return c.next++;
+  }
+
+  signal create_node( signal const& a, signal const& b, uint32_t thread_id )
+  {
+    node_type node;
+    node.children[0] = a;
+    node.children[1] = b;
+
+    auto& s = _stripes[stripe_of( a, b )];
+    std::lock_guard<std::mutex> lock( s.mutex );
+    if ( const auto it = s.table.find( node ); it != s.table.end() )
+    {
+      return { it->second, 0u };
+    }
+
+    /* the node is written before it is published in the table */
+    auto const index = allocate( node, thread_id );
+    s.table[node] = index;
+    return { index, 0u };
+  }
+
+private:
+  uint32_t _num_pis;
+  uint32_t _chunk_bits;
+  uint32_t _stripe_bits;
+  std::vector<std::unique_ptr<node_type[]>> _chunks;
+  std::mutex _chunks_mutex;
+  std::vector<stripe> _stripes;
+  std::vector<cursor> _cursors;
+};
+
+} // namespace mockturtle
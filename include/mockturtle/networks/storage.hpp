@@ -39,8 +39,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -100,6 +105,44 @@ public:
   }
 };
 
+/*! \brief Node pointer with a 32-bit index and weight
+
+  Compact variant of `node_pointer` for networks with less than 2^(32 -
+  PointerFieldSize) nodes.  It offers the same members (`weight`, `index`,
+  and `data`) such that it can replace `node_pointer` in a node type.
+*/
+template<int PointerFieldSize = 0>
+struct compact_node_pointer
+{
+private:
+  static constexpr auto _len = sizeof( uint32_t ) * 8;
+
+public:
+  compact_node_pointer() = default;
+  compact_node_pointer( uint64_t index, uint64_t weight ) : weight( static_cast<uint32_t>( weight ) ), index( static_cast<uint32_t>( index ) ) {}
+  compact_node_pointer( uint64_t data ) : data( static_cast<uint32_t>( data ) ) {}
+
+  union
+  {
+    struct
+    {
+      uint32_t weight : PointerFieldSize;
+      uint32_t index : _len - PointerFieldSize;
+    };
+    uint32_t data;
+  };
+
+  bool operator==( compact_node_pointer<PointerFieldSize> const& other ) const
+  {
+    return data == other.data;
+  }
+
+  bool operator!=( compact_node_pointer<PointerFieldSize> const& other ) const
+  {
+    return data != other.data;
+  }
+};
+
 union cauint64_t
 {
   uint64_t n{ 0 };
@@ -131,6 +174,26 @@ struct regular_node
   }
 };
 
+/*! \brief Regular node with 32-bit child pointers
+
+  Same layout as `regular_node` except for the children, which are stored as
+  `compact_node_pointer`.  A node of an AIG with two data words takes 24
+  instead of 32 bytes.
+*/
+template<int Fanin, int Size = 0, int PointerFieldSize = 0>
+struct compact_regular_node
+{
+  using pointer_type = compact_node_pointer<PointerFieldSize>;
+
+  std::array<pointer_type, Fanin> children;
+  std::array<cauint64_t, Size> data;
+
+  bool operator==( compact_regular_node<Fanin, Size, PointerFieldSize> const& other ) const
+  {
+    return children == other.children;
+  }
+};
+
 template<int Size = 0, int PointerFieldSize = 0>
 struct mixed_fanin_node
 {
@@ -205,17 +268,274 @@ struct node_hash
   }
 };
 
+/*! \brief Structural hash table for nodes with two fan-ins
+
+  Open-addressing table from the two fan-in literals of a node, packed into
+  one 64-bit key, to the node index.  Collisions are resolved by linear
+  probing in a power-of-two array of 16-byte entries, and erasing shifts the
+  following entries back instead of leaving tombstones.
+
+  The table provides the part of the `phmap::flat_hash_map` interface used by
+  the networks: `find` returns a pointer to an entry (the index is in
+  `second`) or `end()`, and `operator[]`, `erase`, `reserve`, `size`, and
+  `clear` behave like their map counterparts.  Literals must fit into 32 bits,
+  i.e., networks using the table have at most `max_nodes` = 2^31 - 1 nodes,
+  which `storage::check_capacity` enforces.
+*/
+template<typename Node>
+class strash_table
+{
+public:
+  struct entry
+  {
+    uint64_t first;
+    uint64_t second;
+  };
+
+  using value_type = entry;
+  using iterator = entry*;
+  using const_iterator = entry const*;
+
+  /*! \brief Maximum number of nodes whose literals fit into a key (all ones marks an empty entry) */
+  static constexpr uint64_t max_nodes = UINT64_C( 0x7fffffff );
+
+public:
+  iterator find( Node const& n )
+  {
+    return const_cast<iterator>( static_cast<strash_table const*>( this )->find( n ) );
+  }
+
+  const_iterator find( Node const& n ) const
+  {
+    return find_key( key( n ) );
+  }
+
+  iterator end() const
+  {
+    return nullptr;
+  }
+
+  uint64_t& operator[]( Node const& n )
+  {
+    if ( 2u * ( _size + 1u ) > _entries.size() )
+    {
+      rehash( std::max<uint64_t>( 2u * _entries.size(), min_capacity ) );
+    }
+
+    auto const k = key( n );
+    auto i = home( k );
+    while ( _entries[i].first != k )
+    {
+      if ( _entries[i].first == empty )
+      {
+        _entries[i] = { k, 0u };
+        ++_size;
+        break;
+      }
+      i = ( i + 1 ) & _mask;
+    }
+    return _entries[i].second;
+  }
+
+  uint64_t erase( Node const& n )
+  {
+    auto it = find( n );
+    if ( it == end() )
+    {
+      return 0u;
+    }
+
+    /* backward shift: move up every following entry whose home slot does not lie in (i, j] */
+    uint64_t i = it - _entries.data();
+    for ( auto j = ( i + 1 ) & _mask; _entries[j].first != empty; j = ( j + 1 ) & _mask )
+    {
+      if ( ( ( j - home( _entries[j].first ) ) & _mask ) >= ( ( j - i ) & _mask ) )
+      {
+        _entries[i] = _entries[j];
+        i = j;
+      }
+    }
+    _entries[i].first = empty;
+    --_size;
+    return 1u;
+  }
+
+  void reserve( uint64_t n )
+  {
+    uint64_t capacity = min_capacity;
+    while ( capacity < 2u * n )
+    {
+      capacity *= 2u;
+    }
+    if ( capacity > _entries.size() )
+    {
+      rehash( capacity );
+    }
+  }
+
+  uint64_t size() const
+  {
+    return _size;
+  }
+
+  uint64_t capacity() const
+  {
+    return _entries.size();
+  }
+
+  void clear()
+  {
+    std::fill( _entries.begin(), _entries.end(), entry{ empty, 0u } );
+    _size = 0u;
+  }
+
+  bool operator==( strash_table const& other ) const
+  {
+    if ( _size != other._size )
+    {
+      return false;
+    }
+    return std::all_of( _entries.begin(), _entries.end(), [&]( auto const& e ) {
+      if ( e.first == empty )
+      {
+        return true;
+      }
+      auto const it = other.find_key( e.first );
+      return it != other.end() && it->second == e.second;
+    } );
+  }
+
+  /*! \brief Writes the table to an archive with `dump( char const*, size_t )` (e.g., `phmap::BinaryOutputArchive`) */
+  template<typename OutputArchive>
+  bool dump( OutputArchive& ar ) const
+  {
+    uint64_t const capacity = _entries.size();
+    return ar.dump( (char const*)&_size, sizeof( uint64_t ) ) &&
+           ar.dump( (char const*)&capacity, sizeof( uint64_t ) ) &&
+           ( capacity == 0u || ar.dump( (char const*)_entries.data(), capacity * sizeof( entry ) ) );
+  }
+
+  /*! \brief Reads a table written by `dump` */
+  template<typename InputArchive>
+  bool load( InputArchive& ar )
+  {
+    uint64_t capacity{};
+    if ( !ar.load( (char*)&_size, sizeof( uint64_t ) ) || !ar.load( (char*)&capacity, sizeof( uint64_t ) ) ||
+         ( capacity & ( capacity - 1u ) ) != 0u )
+    {
+      return false;
+    }
+    _entries.resize( capacity );
+    _mask = capacity - 1u;
+    _shift = 64u - num_bits( capacity );
+    return capacity == 0u || ar.load( (char*)_entries.data(), capacity * sizeof( entry ) );
+  }
+
+private:
+  static constexpr uint64_t empty = ~UINT64_C( 0 );
+  static constexpr uint64_t min_capacity = 16u;
+
+  static uint64_t key( Node const& n )
+  {
+    uint64_t const l0 = 2u * static_cast<uint64_t>( n.children[0].index ) + n.children[0].weight;
+    uint64_t const l1 = 2u * static_cast<uint64_t>( n.children[1].index ) + n.children[1].weight;
+    assert( l0 < UINT64_C( 0xffffffff ) && l1 < UINT64_C( 0xffffffff ) );
+    return ( l0 << 32u ) | l1;
+  }
+
+  const_iterator find_key( uint64_t k ) const
+  {
+    if ( _entries.empty() )
+    {
+      return end();
+    }
+
+    for ( auto i = home( k );; i = ( i + 1 ) & _mask )
+    {
+      if ( _entries[i].first == k )
+      {
+        return &_entries[i];
+      }
+      if ( _entries[i].first == empty )
+      {
+        return end();
+      }
+    }
+  }
+
+  /* Fibonacci hashing: the top bits of the product depend on all bits of the key */
+  uint64_t home( uint64_t k ) const
+  {
+    return ( k * UINT64_C( 0x9e3779b97f4a7c15 ) ) >> _shift;
+  }
+
+  static uint64_t num_bits( uint64_t capacity )
+  {
+    uint64_t l = 0u;
+    while ( ( UINT64_C( 1 ) << l ) < capacity )
+    {
+      ++l;
+    }
+    return l;
+  }
+
+  void rehash( uint64_t capacity )
+  {
+    std::vector<entry> entries( capacity, entry{ empty, 0u } );
+    std::swap( entries, _entries );
+    _mask = capacity - 1u;
+    _shift = 64u - num_bits( capacity );
+
+    for ( auto const& e : entries )
+    {
+      if ( e.first == empty )
+      {
+        continue;
+      }
+      auto i = home( e.first );
+      while ( _entries[i].first != empty )
+      {
+        i = ( i + 1 ) & _mask;
+      }
+      _entries[i] = e;
+    }
+  }
+
+private:
+  std::vector<entry> _entries;
+  uint64_t _size{ 0u };
+  uint64_t _mask{ 0u };
+  uint64_t _shift{ 64u };
+};
+
+/*! \brief Maximum number of nodes a hash table can index, `HashTable::max_nodes` if it defines one */
+template<typename HashTable, typename = void>
+struct hash_table_max_nodes
+{
+  static constexpr uint64_t value = ~UINT64_C( 0 );
+};
+
+template<typename HashTable>
+struct hash_table_max_nodes<HashTable, std::void_t<decltype( HashTable::max_nodes )>>
+{
+  static constexpr uint64_t value = HashTable::max_nodes;
+};
+
 struct empty_storage_data
 {
 };
 
-template<typename Node, typename T = empty_storage_data, typename NodeHasher = node_hash<Node>>
+template<typename Node, typename T = empty_storage_data, typename NodeHasher = node_hash<Node>, typename HashTable = phmap::flat_hash_map<Node, uint64_t, NodeHasher>>
 struct storage
 {
   storage()
   {
     nodes.reserve( 10000u );
-    hash.reserve( 10000u );
+    /* a `strash_table` grows cheaply, so small networks do not pay for a large table */
+    if constexpr ( !std::is_same_v<HashTable, strash_table<Node>> )
+    {
+      hash.reserve( 10000u );
+    }
 
     /* we generally reserve the first node for a constant */
     nodes.emplace_back();
@@ -223,13 +543,26 @@ struct storage
 
   using node_type = Node;
 
+  /*! \brief Maximum number of nodes, limited by the index width of a node pointer and by the hash table */
+  static constexpr uint64_t max_nodes = std::min( UINT64_C( 1 ) << ( 8 * sizeof( typename node_type::pointer_type ) - 1 ),
+                                                  hash_table_max_nodes<HashTable>::value );
+
+  /*! \brief Throws `std::length_error` if no further node can be added */
+  void check_capacity() const
+  {
+    if ( nodes.size() >= max_nodes )
+    {
+      throw std::length_error( "network exceeds the maximum number of nodes of its storage" );
+    }
+  }
+
   uint32_t trav_id = 0u;
 
   std::vector<node_type> nodes;
   std::vector<uint64_t> inputs;
   std::vector<typename node_type::pointer_type> outputs;
 
-  phmap::flat_hash_map<node_type, uint64_t, NodeHasher> hash;
+  HashTable hash;
 
   T data;
 };
@@ -0,0 +1,167 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file block_memory_model.hpp
+  \brief Peak memory models of the algorithms run on partition blocks
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "../networks/aig.hpp"
+
+namespace mockturtle
+{
+
+/*! \brief Estimated peak memory of an algorithm on a block.
+ *
+ * A block with `g` gates whose gates have `f` fanouts in total is
+ * estimated to need
+ *
+ *   fixed_bytes + bytes_per_gate * g + bytes_per_fanout * f + superlinear_bytes * g^exponent
+ *
+ * bytes, which covers the network itself, per-node data of the algorithm
+ * (cut sets, match tables, simulation patterns), fanout lists, and data
+ * which grows faster than the block (e.g., simulation patterns added for
+ * every counter-example).  The default model is the AIG alone.
+ */
+struct block_memory_model
+{
+  /*! \brief Bytes independent of the block size (e.g., a gate library). */
+  uint64_t fixed_bytes{ 0u };
+
+  /*! \brief Bytes per gate (node storage and structural hashing by default). */
+  double bytes_per_gate{ 2.0 * sizeof( aig_storage::node_type ) + sizeof( uint64_t ) };
+
+  /*! \brief Bytes per fanout of a gate. */
+  double bytes_per_fanout{ 0.0 };
+
+  /*! \brief Coefficient of the superlinear term. */
+  double superlinear_bytes{ 0.0 };
+
+  /*! \brief Exponent of the superlinear term. */
+  double exponent{ 2.0 };
+
+  /*! \brief Bytes of a gate with `num_fanouts` fanouts (without the superlinear term). */
+  double gate_bytes( uint32_t num_fanouts ) const
+  {
+    return bytes_per_gate + bytes_per_fanout * num_fanouts;
+  }
+
+  /*! \brief Estimated bytes of a block with `num_gates` gates of `linear_bytes` in total. */
+  double block_bytes( double linear_bytes, uint64_t num_gates ) const
+  {
+    return fixed_bytes + linear_bytes + superlinear_bytes * std::pow( static_cast<double>( num_gates ), exponent );
+  }
+
+  /*! \brief Largest number of gates (of `average_bytes` each) that fits into `budget` bytes, at least 1. */
+  uint64_t max_gates( double average_bytes, uint64_t budget ) const
+  {
+    auto fits = [&]( uint64_t g ) {
+      return block_bytes( average_bytes * g, g ) <= static_cast<double>( budget );
+    };
+    uint64_t lo = 1u, hi = 2u;
+    while ( fits( hi ) && hi < ( uint64_t( 1 ) << 40 ) )
+    {
+      lo = hi;
+      hi *= 2u;
+    }
+    if ( !fits( lo ) )
+    {
+      return 1u;
+    }
+    /* fits( lo ) and !fits( hi ) */
+    while ( hi - lo > 1u )
+    {
+      auto const mid = lo + ( hi - lo ) / 2u;
+      ( fits( mid ) ? lo : hi ) = mid;
+    }
+    return lo;
+  }
+};
+
+/*! \brief Memory model of the AIG of a block alone. */
+inline block_memory_model aig_memory_model()
+{
+  return {};
+}
+
+/*! \brief Memory model of `cut_enumeration` (and algorithms built on it, e.g., `cut_rewriting`).
+ *
+ * Every node keeps up to `cut_limit + 1` cuts of at most `cut_size`
+ * leaves, and with `compute_truth` every cut refers to a truth table of
+ * `2^cut_size` bits in a shared cache.
+ */
+inline block_memory_model cut_enumeration_memory_model( uint32_t cut_size = 4u, uint32_t cut_limit = 25u, bool compute_truth = false )
+{
+  auto model = aig_memory_model();
+  /* leaves, signature, leaf iterators and data of a cut, and its pointer in the cut set */
+  double const cut_bytes = 4.0 * cut_size + 3.0 * sizeof( uint64_t ) + 2.0 * sizeof( uint32_t ) + sizeof( void* );
+  model.bytes_per_gate += ( cut_limit + 1.0 ) * cut_bytes;
+  if ( compute_truth )
+  {
+    model.bytes_per_gate += ( cut_limit + 1.0 ) * std::max( 8.0, std::ldexp( 1.0, static_cast<int>( cut_size ) ) / 8.0 );
+  }
+  return model;
+}
+
+/*! \brief Memory model of `emap` with a library of `num_supergates` supergates.
+ *
+ * The supergate library and its matching tables are shared by the whole
+ * block, every node keeps its cuts (with truth tables), match candidates
+ * for both phases and a fanout list.
+ */
+inline block_memory_model emap_memory_model( uint32_t num_supergates, uint32_t cut_size = 6u, uint32_t cut_limit = 16u )
+{
+  auto model = cut_enumeration_memory_model( cut_size, cut_limit, true );
+  model.fixed_bytes += static_cast<uint64_t>( num_supergates ) * 256u;
+  model.bytes_per_gate += 2.0 * 128.0;
+  model.bytes_per_fanout += sizeof( uint64_t );
+  return model;
+}
+
+/*! \brief Memory model of `sim_resubstitution` with `num_patterns` initial patterns.
+ *
+ * Every node keeps a simulation signature of one bit per pattern, and the
+ * SAT-based validation adds a pattern for every counter-example; assuming
+ * one counter-example every `gates_per_cex` gates, the signatures grow
+ * quadratically with the block.
+ */
+inline block_memory_model sim_resub_memory_model( uint32_t num_patterns = 1024u, uint32_t gates_per_cex = 16u )
+{
+  auto model = aig_memory_model();
+  model.bytes_per_gate += num_patterns / 8.0 + 2.0 * sizeof( uint64_t );
+  model.bytes_per_fanout += sizeof( uint64_t );
+  model.superlinear_bytes = 1.0 / ( 8.0 * std::max( gates_per_cex, 1u ) );
+  model.exponent = 2.0;
+  return model;
+}
+
+} // namespace mockturtle
@@ -0,0 +1,123 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file parallel_utils.hpp
+  \brief Utilities to run independent tasks on several threads
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mockturtle
+{
+
+/*! \brief Number of worker threads to use.
+ *
+ * Returns `num_threads` if it is non-zero, otherwise the number of
+ * hardware threads (at least 1).
+ */
+inline uint32_t resolve_num_threads( uint32_t num_threads )
+{
+  if ( num_threads != 0u )
+  {
+    return num_threads;
+  }
+  return std::max( 1u, std::thread::hardware_concurrency() );
+}
+
+/*! \brief Runs `fn( task, thread_id )` for all tasks in `[0, num_tasks)`.
+ *
+ * The tasks are handed out dynamically to at most `num_threads` worker
+ * threads: an idle worker takes the next unprocessed task, so that a few
+ * large tasks do not stall the others.  Results should be written to
+ * per-task slots to keep the outcome independent of the scheduling.  The
+ * `thread_id` (in `[0, num_threads)`) can be used to index per-thread
+ * scratch data.  The first exception thrown by a task is re-thrown after
+ * all workers have finished.
+ *
+ * If only one thread is requested (or only one task exists), the tasks
+ * are run in order on the calling thread.
+ */
+template<typename Fn>
+void parallel_for( uint32_t num_tasks, uint32_t num_threads, Fn&& fn )
+{
+  num_threads = std::min( resolve_num_threads( num_threads ), num_tasks );
+  if ( num_threads <= 1u )
+  {
+    for ( auto i = 0u; i < num_tasks; ++i )
+    {
+      fn( i, 0u );
+    }
+    return;
+  }
+
+  std::atomic<uint32_t> next{ 0u };
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  std::vector<std::thread> threads;
+  for ( auto t = 0u; t < num_threads; ++t )
+  {
+    threads.emplace_back(
+        [&]( uint32_t id ) {
+          for ( auto i = next++; i < num_tasks; i = next++ )
+          {
+            try
+            {
+              fn( i, id );
+            }
+            catch ( ... )
+            {
+              std::lock_guard<std::mutex> lock( error_mutex );
+              if ( !error )
+              {
+                error = std::current_exception();
+              }
+            }
+          }
+        },
+        t );
+  }
+
+  for ( auto& t : threads )
+  {
+    t.join();
+  }
+
+  if ( error )
+  {
+    std::rethrow_exception( error );
+  }
+}
+
+} // namespace mockturtle
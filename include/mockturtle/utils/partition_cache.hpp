@@ -0,0 +1,314 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file partition_cache.hpp
+  \brief Persistent cache of partitions
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "../networks/aig.hpp"
+#include "../views/partition_view.hpp"
+
+namespace mockturtle
+{
+
+/*! \brief Persistent cache of partitions.
+ *
+ * Stores the dense node-to-block vector of a partition in a binary file
+ * named after a structural hash of the network and a hash of the
+ * partition parameters (number of blocks, imbalance, seed, weights and
+ * block size limits) and of a tag naming the partitioner with its
+ * configuration, e.g., `"mt-kahypar:deterministic:km1"` or `"native"`.
+ * A later run on the same network with the same parameters and the same
+ * partitioner loads the partition without building the hypergraph or
+ * calling the partitioner.
+ *
+ * The file holds a small header (magic, version, both hashes, number of
+ * nodes and blocks) followed by the blocks of all nodes but the
+ * constant, using 1, 2 or 4 bytes per node depending on the number of
+ * blocks.  All integers are stored in little-endian byte order.  A file is
+ * written to a temporary name and renamed into place, so concurrent runs
+ * never read a partially written file.
+ *
+ * **Example**
+ *
+   \verbatim embed:rst
+
+   .. code-block:: c++
+
+      partition_cache cache( "partitions" );
+      auto node_block = cache.get_or_compute( aig, ps, "mt-kahypar:deterministic:km1", [&]() {
+        partition_view aig_p{ aig, ps };
+        // ... partition with mt-KaHyPar
+        return aig_p.node_to_block( partition.get(), aig_p.num_vertices() );
+      } );
+   \endverbatim
+ */
+class partition_cache
+{
+public:
+  using block_id = partition_view::block_id;
+
+  explicit partition_cache( std::string const& directory = "." )
+      : _directory( directory )
+  {
+  }
+
+  /*! \brief Structural hash of an AIG (PIs, fanins of all gates and POs in order). */
+  static uint64_t structural_hash( aig_network const& ntk )
+  {
+    uint64_t h = hash_combine( 0u, ntk.num_pis() );
+    ntk.foreach_gate( [&]( auto const& n ) {
+      ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        h = hash_combine( h, literal( ntk, fi ) );
+      } );
+    } );
+    h = hash_combine( h, ntk.num_pos() );
+    ntk.foreach_po( [&]( auto const& f ) {
+      h = hash_combine( h, literal( ntk, f ) );
+    } );
+    return h;
+  }
+
+  /*! \brief Hash of the parameters and the partitioner (with preset and objective) which influence the partition. */
+  static uint64_t params_hash( partition_view_params const& ps, std::string const& partitioner )
+  {
+    uint64_t h = hash_combine( 0u, partitioner.size() );
+    for ( auto const& c : partitioner )
+    {
+      h = hash_combine( h, static_cast<uint8_t>( c ) );
+    }
+    h = hash_combine( h, static_cast<uint64_t>( ps.num_blocks ) );
+    h = hash_combine( h, double_bits( ps.epsilon ) );
+    h = hash_combine( h, ps.seed );
+    h = hash_combine( h, ( ps.skip_po_as_sink ? 1u : 0u ) | ( ps.si_w_on_hyperedges ? 2u : 0u ) | ( ps.si_w_on_vertices ? 4u : 0u ) | ( ps.timing_weights ? 8u : 0u ) );
+    h = hash_combine( h, ps.critical_weight );
+    h = hash_combine( h, ps.max_block_size );
+    h = hash_combine( h, ps.max_block_memory );
+    if ( ps.max_block_memory != 0u )
+    {
+      auto const& m = ps.memory_model;
+      h = hash_combine( h, m.fixed_bytes );
+      h = hash_combine( h, double_bits( m.bytes_per_gate ) );
+      h = hash_combine( h, double_bits( m.bytes_per_fanout ) );
+      h = hash_combine( h, double_bits( m.superlinear_bytes ) );
+      h = hash_combine( h, double_bits( m.exponent ) );
+    }
+    return h;
+  }
+
+  /*! \brief File holding the partition of `ntk` computed by `partitioner` with parameters `ps`. */
+  std::string file_name( aig_network const& ntk, partition_view_params const& ps, std::string const& partitioner ) const
+  {
+    return fmt::format( "{}/{:016x}_{:016x}.part", _directory, structural_hash( ntk ), params_hash( ps, partitioner ) );
+  }
+
+  /*! \brief Loads a cached partition, `std::nullopt` if there is none (or it does not match). */
+  std::optional<std::vector<block_id>> load( aig_network const& ntk, partition_view_params const& ps, std::string const& partitioner ) const
+  {
+    std::ifstream is( file_name( ntk, ps, partitioner ), std::ifstream::binary );
+    if ( !is )
+    {
+      return std::nullopt;
+    }
+
+    if ( read_uint( is, 4u ) != magic || read_uint( is, 4u ) != version ||
+         read_uint( is, 8u ) != structural_hash( ntk ) || read_uint( is, 8u ) != params_hash( ps, partitioner ) ||
+         read_uint( is, 8u ) != ntk.size() )
+    {
+      return std::nullopt;
+    }
+    auto const num_blocks = static_cast<uint32_t>( read_uint( is, 4u ) );
+    auto const width = entry_width( num_blocks );
+
+    std::vector<uint8_t> buffer( ( ntk.size() - 1u ) * width );
+    is.read( reinterpret_cast<char*>( buffer.data() ), buffer.size() );
+    if ( !is || static_cast<size_t>( is.gcount() ) != buffer.size() )
+    {
+      return std::nullopt;
+    }
+
+    std::vector<block_id> node_block( ntk.size() );
+    node_block[0] = -1;
+    for ( auto i = 1u; i < ntk.size(); ++i )
+    {
+      uint32_t b = 0u;
+      for ( auto j = 0u; j < width; ++j )
+      {
+        b |= static_cast<uint32_t>( buffer[( i - 1u ) * width + j] ) << ( 8u * j );
+      }
+      if ( b >= num_blocks )
+      {
+        return std::nullopt;
+      }
+      node_block[i] = static_cast<block_id>( b );
+    }
+    return node_block;
+  }
+
+  /*! \brief Stores the partition `node_block` of `ntk` computed by `partitioner` with parameters `ps`. */
+  bool store( aig_network const& ntk, partition_view_params const& ps, std::string const& partitioner, std::vector<block_id> const& node_block ) const
+  {
+    assert( node_block.size() == ntk.size() );
+    uint32_t num_blocks = 0u;
+    for ( auto i = 1u; i < node_block.size(); ++i )
+    {
+      assert( node_block[i] >= 0 );
+      num_blocks = std::max( num_blocks, static_cast<uint32_t>( node_block[i] ) + 1u );
+    }
+    auto const width = entry_width( num_blocks );
+
+    std::vector<uint8_t> buffer;
+    buffer.reserve( header_size + ( ntk.size() - 1u ) * width );
+    append_uint( buffer, magic, 4u );
+    append_uint( buffer, version, 4u );
+    append_uint( buffer, structural_hash( ntk ), 8u );
+    append_uint( buffer, params_hash( ps, partitioner ), 8u );
+    append_uint( buffer, ntk.size(), 8u );
+    append_uint( buffer, num_blocks, 4u );
+    for ( auto i = 1u; i < node_block.size(); ++i )
+    {
+      append_uint( buffer, static_cast<uint32_t>( node_block[i] ), width );
+    }
+
+    /* write to a temporary file next to the cache file and rename it into place */
+    auto const name = file_name( ntk, ps, partitioner );
+    auto const tmp_name = fmt::format( "{}.{:08x}.tmp", name, std::random_device{}() );
+    {
+      std::ofstream os( tmp_name, std::ofstream::binary | std::ofstream::trunc );
+      os.write( reinterpret_cast<char const*>( buffer.data() ), buffer.size() );
+      os.close();
+      if ( !os )
+      {
+        std::remove( tmp_name.c_str() );
+        return false;
+      }
+    }
+    if ( std::rename( tmp_name.c_str(), name.c_str() ) != 0 )
+    {
+      /* renaming onto an existing file fails on some platforms */
+      std::remove( name.c_str() );
+      if ( std::rename( tmp_name.c_str(), name.c_str() ) != 0 )
+      {
+        std::remove( tmp_name.c_str() );
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Loads the partition if it is cached, otherwise computes it with `fn` and stores it.
+   *
+   * A partition which cannot be stored is still returned, with a warning
+   * on `stderr`.
+   */
+  template<typename Fn>
+  std::vector<block_id> get_or_compute( aig_network const& ntk, partition_view_params const& ps, std::string const& partitioner, Fn&& fn ) const
+  {
+    if ( auto cached = load( ntk, ps, partitioner ) )
+    {
+      return *cached;
+    }
+    std::vector<block_id> node_block = fn();
+    if ( !store( ntk, ps, partitioner, node_block ) )
+    {
+      fmt::print( stderr, "[w] could not store the partition in {}\n", file_name( ntk, ps, partitioner ) );
+    }
+    return node_block;
+  }
+
+private:
+  static constexpr uint64_t magic = 0x43505253u; /* "SRPC" */
+  static constexpr uint64_t version = 1u;
+  static constexpr size_t header_size = 4u + 4u + 8u + 8u + 8u + 4u;
+
+  static uint64_t literal( aig_network const& ntk, aig_network::signal const& f )
+  {
+    return 2u * static_cast<uint64_t>( ntk.node_to_index( ntk.get_node( f ) ) ) + ( ntk.is_complemented( f ) ? 1u : 0u );
+  }
+
+  static uint64_t double_bits( double value )
+  {
+    uint64_t bits;
+    static_assert( sizeof( bits ) == sizeof( value ) );
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+  }
+
+  /* splitmix64 finalizer, platform independent unlike std::hash */
+  static uint64_t hash_combine( uint64_t seed, uint64_t value )
+  {
+    uint64_t z = seed ^ ( value + 0x9e3779b97f4a7c15ull + ( seed << 6 ) + ( seed >> 2 ) );
+    z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+    z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+    return z ^ ( z >> 31 );
+  }
+
+  static uint32_t entry_width( uint32_t num_blocks )
+  {
+    return num_blocks <= 0x100u ? 1u : ( num_blocks <= 0x10000u ? 2u : 4u );
+  }
+
+  static void append_uint( std::vector<uint8_t>& buffer, uint64_t value, uint32_t bytes )
+  {
+    for ( auto j = 0u; j < bytes; ++j )
+    {
+      buffer.push_back( static_cast<uint8_t>( value >> ( 8u * j ) ) );
+    }
+  }
+
+  static uint64_t read_uint( std::istream& is, uint32_t bytes )
+  {
+    std::array<uint8_t, 8u> data{};
+    is.read( reinterpret_cast<char*>( data.data() ), bytes );
+    uint64_t value = 0u;
+    for ( auto j = 0u; j < bytes; ++j )
+    {
+      value |= static_cast<uint64_t>( data[j] ) << ( 8u * j );
+    }
+    return value;
+  }
+
+private:
+  std::string _directory;
+};
+
+} // namespace mockturtle
@@ -0,0 +1,274 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file process_utils.hpp
+  \brief Utilities to run independent tasks in forked worker processes
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define MOCKTURTLE_HAS_FORK 1
+#else
+#define MOCKTURTLE_HAS_FORK 0
+#endif
+
+#include "parallel_utils.hpp"
+
+namespace mockturtle
+{
+
+/*! \brief Outcome of a task run in a worker process. */
+enum class process_status : uint8_t
+{
+  /*! \brief The task finished and its result was transferred. */
+  success,
+  /*! \brief The worker process crashed or could not be started. */
+  failed,
+  /*! \brief The task was killed after exceeding its timeout. */
+  timeout,
+  /*! \brief The result did not fit into the shared buffer. */
+  overflow
+};
+
+/*! \brief Whether `run_in_processes` can fork on this platform. */
+inline constexpr bool has_process_workers()
+{
+  return MOCKTURTLE_HAS_FORK != 0;
+}
+
+/*! \brief Runs `fn( task, result )` for all tasks in `[0, num_tasks)`, each in its own process.
+ *
+ * Every task is run in a child process forked from the calling process,
+ * at most `num_processes` at a time, so the task sees all data of the
+ * parent (copy-on-write) and a crash, `abort` or runaway loop in the
+ * task cannot harm the parent.  The task writes its result into the
+ * string `result`, which is sent back through an anonymous shared memory
+ * buffer of `buffer_size` bytes per running process.  `done( task,
+ * status, data, size )` is called in the parent, in completion order, for
+ * every task; `data` and `size` are the result for `success` and empty
+ * otherwise.  Tasks running longer than `timeout` seconds (0: no limit)
+ * are killed.  If `done` throws, the running workers are killed and
+ * reaped before the exception propagates.
+ *
+ * Only the calling thread exists in the children, so `fn` must not rely
+ * on locks or thread pools of the parent.  Without `fork` (e.g., on
+ * Windows) the tasks run on threads instead, without isolation or
+ * timeouts.
+ */
+template<typename Fn, typename Done>
+void run_in_processes( uint32_t num_tasks, uint32_t num_processes, double timeout, size_t buffer_size, Fn&& fn, Done&& done )
+{
+  num_processes = std::min( resolve_num_threads( num_processes ), std::max( num_tasks, 1u ) );
+
+#if MOCKTURTLE_HAS_FORK
+  /* per slot: a header ( result size, 1 if complete, 2 if too large ) followed by the buffer */
+  struct slot_header
+  {
+    uint64_t size;
+    uint64_t complete;
+  };
+  size_t const slot_size = sizeof( slot_header ) + ( ( buffer_size + 7u ) & ~size_t( 7u ) );
+  void* shared = mmap( nullptr, slot_size * num_processes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+  if ( shared == MAP_FAILED )
+  {
+    for ( auto i = 0u; i < num_tasks; ++i )
+    {
+      done( i, process_status::failed, nullptr, size_t( 0 ) );
+    }
+    return;
+  }
+  auto header = [&]( uint32_t s ) { return reinterpret_cast<slot_header*>( static_cast<char*>( shared ) + s * slot_size ); };
+  auto data = [&]( uint32_t s ) { return reinterpret_cast<char*>( header( s ) + 1 ); };
+
+  using clock = std::chrono::steady_clock;
+  struct running_task
+  {
+    pid_t pid{ -1 };
+    uint32_t task{ 0u };
+    clock::time_point start;
+    bool killed{ false };
+  };
+  std::vector<running_task> slots( num_processes );
+
+  /* kills and reaps the running workers and unmaps the buffer on any exit, e.g., if `done` throws */
+  struct cleanup_guard
+  {
+    std::vector<running_task>& slots;
+    void* shared;
+    size_t size;
+
+    ~cleanup_guard()
+    {
+      for ( auto& r : slots )
+      {
+        if ( r.pid != -1 )
+        {
+          kill( r.pid, SIGKILL );
+          waitpid( r.pid, nullptr, 0 );
+          r.pid = -1;
+        }
+      }
+      munmap( shared, size );
+    }
+  } guard{ slots, shared, slot_size * num_processes };
+
+  /* children inherit unflushed output, which they would print again */
+  std::fflush( stdout );
+  std::fflush( stderr );
+
+  uint32_t next = 0u, num_running = 0u;
+  while ( next < num_tasks || num_running > 0u )
+  {
+    /* start tasks on free slots */
+    for ( auto s = 0u; s < num_processes && next < num_tasks; ++s )
+    {
+      if ( slots[s].pid != -1 )
+      {
+        continue;
+      }
+      header( s )->size = 0u;
+      header( s )->complete = 0u;
+      auto const task = next++;
+      pid_t const pid = fork();
+      if ( pid == 0 )
+      {
+        /* crash handlers of the parent (e.g., of a test framework) must not run in the worker */
+        for ( auto const sig : { SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV } )
+        {
+          std::signal( sig, SIG_DFL );
+        }
+
+        /* the child must never return into the caller */
+        try
+        {
+          std::string result;
+          fn( task, result );
+          if ( result.size() > buffer_size )
+          {
+            header( s )->complete = 2u;
+          }
+          else
+          {
+            std::memcpy( data( s ), result.data(), result.size() );
+            header( s )->size = result.size();
+            header( s )->complete = 1u;
+          }
+        }
+        catch ( ... )
+        {
+          std::_Exit( 1 );
+        }
+        std::fflush( stdout );
+        std::_Exit( 0 );
+      }
+      if ( pid < 0 )
+      {
+        done( task, process_status::failed, nullptr, size_t( 0 ) );
+        continue;
+      }
+      slots[s] = { pid, task, clock::now(), false };
+      ++num_running;
+    }
+
+    /* collect finished workers, kill the ones over time */
+    bool collected = false;
+    auto const now = clock::now();
+    for ( auto s = 0u; s < num_processes; ++s )
+    {
+      auto& r = slots[s];
+      if ( r.pid == -1 )
+      {
+        continue;
+      }
+      int wstatus;
+      if ( waitpid( r.pid, &wstatus, WNOHANG ) != r.pid )
+      {
+        if ( !r.killed && timeout > 0.0 && std::chrono::duration<double>( now - r.start ).count() > timeout )
+        {
+          kill( r.pid, SIGKILL );
+          r.killed = true;
+        }
+        continue;
+      }
+      r.pid = -1;
+      --num_running;
+      collected = true;
+
+      bool const exited = WIFEXITED( wstatus ) && WEXITSTATUS( wstatus ) == 0;
+      if ( exited && header( s )->complete == 1u )
+      {
+        done( r.task, process_status::success, static_cast<char const*>( data( s ) ), static_cast<size_t>( header( s )->size ) );
+      }
+      else if ( exited && header( s )->complete == 2u )
+      {
+        done( r.task, process_status::overflow, nullptr, size_t( 0 ) );
+      }
+      else
+      {
+        done( r.task, r.killed ? process_status::timeout : process_status::failed, nullptr, size_t( 0 ) );
+      }
+    }
+    if ( !collected )
+    {
+      std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );
+    }
+  }
+#else
+  (void)timeout;
+  std::vector<std::string> results( num_tasks );
+  parallel_for( num_tasks, num_processes, [&]( uint32_t i, uint32_t ) {
+    fn( i, results[i] );
+  } );
+  for ( auto i = 0u; i < num_tasks; ++i )
+  {
+    if ( results[i].size() > buffer_size )
+    {
+      done( i, process_status::overflow, nullptr, size_t( 0 ) );
+    }
+    else
+    {
+      done( i, process_status::success, results[i].data(), results[i].size() );
+    }
+  }
+#endif
+}
+
+} // namespace mockturtle
@@ -175,7 +175,8 @@ std::vector<typename Ntk::node> collect_inputs( Ntk const& ntk, std::vector<type
     ntk.paint( n );
   }
 
-  /* if a fanin is not colored, then it's an input */
+  /* if a fanin is not colored, then it's an input; inputs are marked
+     as soon as they are found to avoid duplicates */
   std::vector<node> inputs;
   for ( const auto& n : nodes )
   {
@@ -183,21 +184,13 @@ std::vector<typename Ntk::node> collect_inputs( Ntk const& ntk, std::vector<type
       node const i = ntk.get_node( fi );
       if ( ntk.eval_color( i, [&ntk]( auto c ) { return c != ntk.current_color(); } ) )
       {
-        if ( std::find( std::begin( inputs ), std::end( inputs ), i ) == std::end( inputs ) )
-        {
-          inputs.push_back( i );
-        }
+        inputs.push_back( i );
+        ntk.paint( i );
       }
       return true;
     } );
   }
 
-  /* mark all inputs */
-  for ( const auto& n : inputs )
-  {
-    ntk.paint( n );
-  }
-
   return inputs;
 }
 
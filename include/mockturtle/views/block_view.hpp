@@ -0,0 +1,277 @@
+/* mockturtle: C++ logic network library
+ * Copyright (C) 2018-2023  EPFL
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*!
+  \file block_view.hpp
+  \brief Implements an isolated view on a block of a partition
+*/
+
+#pragma once
+
+#include "../networks/detail/foreach.hpp"
+#include "../traits.hpp"
+#include "../utils/algorithm.hpp"
+#include "../utils/window_utils.hpp"
+#include "immutable_view.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace mockturtle
+{
+
+/*! \brief Implements an isolated view on a block of a partition.
+ *
+ * Like `window_view`, this view exposes a part of a large network as a
+ * network of its own, without copying any node of the storage.  The
+ * block is given by its boundary, as computed by
+ * `partition_view::collect_boundaries`:
+ *   1.) `inputs` are the nodes outside of the block read by the block,
+ *       they are the PIs of the view,
+ *   2.) `outputs` are the signals of the block read outside of it, they
+ *       are the POs of the view,
+ *   3.) `gates` are the nodes of the block.
+ *
+ * Both `inputs` and `gates` must be sorted by node index, which is then
+ * a topological order, so that membership and index queries are binary
+ * searches and no hash map is needed.  Read-only algorithms (simulation,
+ * cut enumeration, `depth_view`, ...) can run on the view directly, an
+ * independent network is only created by `materialize` when the block is
+ * going to be modified.
+ */
+template<typename Ntk>
+class block_view : public immutable_view<Ntk>
+{
+public:
+  using storage = typename Ntk::storage;
+  using node = typename Ntk::node;
+  using signal = typename Ntk::signal;
+
+public:
+  explicit block_view( Ntk const& ntk, std::vector<node> inputs, std::vector<signal> outputs, std::vector<node> gates )
+      : immutable_view<Ntk>( ntk ), _inputs( std::move( inputs ) ), _outputs( std::move( outputs ) ), _gates( std::move( gates ) )
+  {
+    assert( std::is_sorted( _inputs.begin(), _inputs.end() ) );
+    assert( std::is_sorted( _gates.begin(), _gates.end() ) );
+  }
+
+#pragma region Block
+  inline bool belongs_to( node const& n ) const
+  {
+    return std::binary_search( _gates.begin(), _gates.end(), n );
+  }
+
+  std::vector<node> const& inputs() const
+  {
+    return _inputs;
+  }
+
+  std::vector<signal> const& outputs() const
+  {
+    return _outputs;
+  }
+
+  std::vector<node> const& gates() const
+  {
+    return _gates;
+  }
+
+  /*! \brief Copies the logic of the block into an independent network. */
+  template<typename NtkDest = Ntk>
+  NtkDest materialize() const
+  {
+    NtkDest dest;
+    clone_subnetwork( static_cast<Ntk const&>( *this ), _inputs, _outputs, _gates, dest );
+    return dest;
+  }
+#pragma endregion
+
+#pragma region Structural properties
+  inline uint32_t size() const
+  {
+    return static_cast<uint32_t>( 1u + _inputs.size() + _gates.size() );
+  }
+
+  inline uint32_t num_cis() const
+  {
+    return num_pis();
+  }
+
+  inline uint32_t num_cos() const
+  {
+    return num_pos();
+  }
+
+  inline uint32_t num_pis() const
+  {
+    return static_cast<uint32_t>( _inputs.size() );
+  }
+
+  inline uint32_t num_pos() const
+  {
+    return static_cast<uint32_t>( _outputs.size() );
+  }
+
+  inline uint32_t num_registers() const
+  {
+    return 0u;
+  }
+
+  inline uint32_t num_gates() const
+  {
+    return static_cast<uint32_t>( _gates.size() );
+  }
+
+  inline uint32_t fanout_size( node const& n ) const = delete;
+
+  inline uint32_t node_to_index( node const& n ) const
+  {
+    if ( this->is_constant( n ) )
+    {
+      return 0u;
+    }
+    if ( auto it = std::lower_bound( _inputs.begin(), _inputs.end(), n ); it != _inputs.end() && *it == n )
+    {
+      return static_cast<uint32_t>( 1u + ( it - _inputs.begin() ) );
+    }
+    auto it = std::lower_bound( _gates.begin(), _gates.end(), n );
+    assert( it != _gates.end() && *it == n );
+    return static_cast<uint32_t>( 1u + _inputs.size() + ( it - _gates.begin() ) );
+  }
+
+  inline node index_to_node( uint32_t index ) const
+  {
+    if ( index == 0u )
+    {
+      return this->get_node( this->get_constant( false ) );
+    }
+    return index <= _inputs.size() ? _inputs[index - 1u] : _gates[index - 1u - _inputs.size()];
+  }
+
+  inline bool is_pi( node const& n ) const
+  {
+    return std::binary_search( _inputs.begin(), _inputs.end(), n );
+  }
+
+  inline bool is_ci( node const& n ) const
+  {
+    return is_pi( n );
+  }
+
+  signal po_at( uint32_t index ) const
+  {
+    assert( index < _outputs.size() );
+    return _outputs[index];
+  }
+
+  signal co_at( uint32_t index ) const
+  {
+    return po_at( index );
+  }
+#pragma endregion
+
+#pragma region Node and signal iterators
+  template<typename Fn>
+  void foreach_pi( Fn&& fn ) const
+  {
+    detail::foreach_element( _inputs.begin(), _inputs.end(), fn );
+  }
+
+  template<typename Fn>
+  void foreach_po( Fn&& fn ) const
+  {
+    detail::foreach_element( _outputs.begin(), _outputs.end(), fn );
+  }
+
+  template<typename Fn>
+  void foreach_ci( Fn&& fn ) const
+  {
+    foreach_pi( fn );
+  }
+
+  template<typename Fn>
+  void foreach_co( Fn&& fn ) const
+  {
+    foreach_po( fn );
+  }
+
+  template<typename Fn>
+  void foreach_ro( Fn&& fn ) const
+  {
+    (void)fn;
+  }
+
+  template<typename Fn>
+  void foreach_ri( Fn&& fn ) const
+  {
+    (void)fn;
+  }
+
+  template<typename Fn>
+  void foreach_register( Fn&& fn ) const
+  {
+    (void)fn;
+  }
+
+  template<typename Fn>
+  void foreach_node( Fn&& fn ) const
+  {
+    auto r = range<uint32_t>( size() );
+    detail::foreach_element_transform<decltype( r.begin() ), node>(
+        r.begin(), r.end(),
+        [this]( auto index ) { return index_to_node( index ); },
+        fn );
+  }
+
+  template<typename Fn>
+  void foreach_gate( Fn&& fn ) const
+  {
+    detail::foreach_element( _gates.begin(), _gates.end(), fn );
+  }
+
+  template<typename Fn>
+  void foreach_fanin( node const& n, Fn&& fn ) const
+  {
+    /* constants and inputs do not have fanins */
+    if ( this->is_constant( n ) || is_pi( n ) )
+    {
+      return;
+    }
+
+    /* if it's not a block input, the node has to be a block gate */
+    assert( belongs_to( n ) );
+    immutable_view<Ntk>::foreach_fanin( n, fn );
+  }
+#pragma endregion
+
+protected:
+  std::vector<node> _inputs;
+  std::vector<signal> _outputs;
+  std::vector<node> _gates;
+}; /* block_view */
+
+} /* namespace mockturtle */
@@ -5,20 +5,37 @@
   \author Jingren Wang
 */
 
+#pragma once
+
 #include "fanout_view.hpp"
 #include "mtkahypar.h"
 #include "mtkahypartypes.h"
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <fmt/format.h>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <mockturtle/algorithms/cleanup.hpp>
+#include <mockturtle/io/hypergraph_csr.hpp>
 #include <mockturtle/networks/aig.hpp>
 #include <mockturtle/traits.hpp>
+#include <mockturtle/utils/block_memory_model.hpp>
 #include <mockturtle/utils/debugging_utils.hpp>
 #include <mockturtle/utils/network_utils.hpp>
+#include <mockturtle/utils/parallel_utils.hpp>
+#include <mockturtle/utils/stopwatch.hpp>
 #include <mockturtle/utils/window_utils.hpp>
+#include <mockturtle/views/block_view.hpp>
 #include <mockturtle/views/color_view.hpp>
 #include <mockturtle/views/depth_view.hpp>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -37,6 +54,23 @@ struct partition_view_params
   /*! \brief Simulate weight on vertices. */
   bool si_w_on_vertices{ false };
 
+  /*! \brief Timing-driven weights on hyperedges and vertices (overrides the simulated weights).
+   *
+   * Hyperedges get heavier the smaller the slack of their source node is,
+   * so that critical paths are rarely cut, and gates on a critical path
+   * weigh twice as much as the others.
+   */
+  bool timing_weights{ false };
+
+  /*! \brief Weight of a hyperedge on a critical path when using timing weights. */
+  uint32_t critical_weight{ 16u };
+
+  /*! \brief Dump the hypergraph in hMetis format (debug output only). */
+  bool write_hmetis{ false };
+
+  /*! \brief Dump the hypergraph in binary CSR format to `file_name + ".csr"` (see `hypergraph_csr.hpp`). */
+  bool write_csr{ false };
+
   /*! \brief Write out to the specific file name */
   std::string file_name{ "tmp.hmetis" };
 
@@ -48,8 +82,117 @@ struct partition_view_params
 
   /*! \brief Epsilon */
   double epsilon{ 0.03 };
+
+  /*! \brief Number of threads for block extraction and reunion (0: all hardware threads).
+   *
+   * The optimization of the blocks by `partition_optimizer` uses
+   * `partition_optimization_params::num_threads` instead.
+   */
+  uint32_t num_threads{ 0u };
+
+  /*! \brief Levels of fanin and fanout context from neighbouring blocks added to every extracted block (0: disjoint blocks).
+   *
+   * The context (halo) gates are read-only divisors: they are cloned into
+   * the block's network, but stay owned by their own block.
+   */
+  uint32_t halo_levels{ 0u };
+
+  /*! \brief Maximum number of gates per block in recursive partitioning (0: no limit). */
+  uint32_t max_block_size{ 0u };
+
+  /*! \brief Maximum memory per block in bytes in recursive partitioning (0: no limit).
+   *
+   * The memory of a block is estimated with `memory_model`, and the
+   * vertex weights become the estimated bytes of the gates.
+   */
+  uint64_t max_block_memory{ 0u };
+
+  /*! \brief Peak memory model of the algorithm run on the blocks. */
+  block_memory_model memory_model{};
+
+  /*! \brief Be verbose. */
+  bool verbose{ false };
+};
+
+struct partition_view_stats
+{
+  /*! \brief Runtime of building the hypergraph. */
+  stopwatch<>::duration time_build{ 0 };
+
+  /*! \brief Runtime of writing the hypergraph files. */
+  stopwatch<>::duration time_write{ 0 };
+
+  /*! \brief Runtime of partitioning inside the view (recursive partitioning, refinement). */
+  stopwatch<>::duration time_partition{ 0 };
+
+  /*! \brief Runtime of extracting the blocks. */
+  stopwatch<>::duration time_extract{ 0 };
+
+  /*! \brief Runtime of the reunion. */
+  stopwatch<>::duration time_reunite{ 0 };
+
+  /*! \brief Number of hyperedges connecting more than one block (last extraction). */
+  uint32_t num_cut_hyperedges{ 0u };
+
+  /*! \brief Sum of the number of blocks minus one over all hyperedges (last extraction). */
+  uint64_t km1{ 0u };
+
+  /*! \brief Gates of the largest block over the average minus one (last extraction). */
+  double imbalance{ 0.0 };
+
+  struct block_stats
+  {
+    uint32_t num_gates{ 0u };
+    uint32_t num_pis{ 0u };
+    uint32_t num_pos{ 0u };
+    uint32_t num_halo_gates{ 0u };
+  };
+
+  /*! \brief Size of every block (last extraction). */
+  std::vector<block_stats> blocks;
+
+  void report() const
+  {
+    std::cout << fmt::format( "[i] blocks         = {:>8}\n", blocks.size() );
+    std::cout << fmt::format( "[i] cut hyperedges = {:>8} (km1 = {})\n", num_cut_hyperedges, km1 );
+    std::cout << fmt::format( "[i] imbalance      = {:>8.3f}\n", imbalance );
+    std::cout << fmt::format( "[i] build time     = {:>8.3f} secs\n", to_seconds( time_build ) );
+    std::cout << fmt::format( "[i] write time     = {:>8.3f} secs\n", to_seconds( time_write ) );
+    std::cout << fmt::format( "[i] partition time = {:>8.3f} secs\n", to_seconds( time_partition ) );
+    std::cout << fmt::format( "[i] extract time   = {:>8.3f} secs\n", to_seconds( time_extract ) );
+    std::cout << fmt::format( "[i] reunite time   = {:>8.3f} secs\n", to_seconds( time_reunite ) );
+  }
 };
 
+/*! \brief JSON representation of `partition_view_stats`, e.g., for a column of `experiment<>`.
+ *
+ * Found by nlohmann::json through argument-dependent lookup, so this file
+ * does not need to include the JSON library.
+ */
+template<class Json>
+void to_json( Json& j, partition_view_stats const& st )
+{
+  j = Json::object();
+  j["time_build"] = to_seconds( st.time_build );
+  j["time_write"] = to_seconds( st.time_write );
+  j["time_partition"] = to_seconds( st.time_partition );
+  j["time_extract"] = to_seconds( st.time_extract );
+  j["time_reunite"] = to_seconds( st.time_reunite );
+  j["cut_hyperedges"] = st.num_cut_hyperedges;
+  j["km1"] = st.km1;
+  j["imbalance"] = st.imbalance;
+  j["blocks"] = Json::array();
+  for ( auto const& b : st.blocks )
+  {
+    Json block = Json::object();
+    block["gates"] = b.num_gates;
+    block["pis"] = b.num_pis;
+    block["pos"] = b.num_pos;
+    block["halo_gates"] = b.num_halo_gates;
+    j["blocks"].push_back( block );
+  }
+}
+
 class partition_view
 {
 public:
@@ -59,35 +202,430 @@ public:
   using node_id_k = unsigned long int;
   using block_id = int;
   using edge_id = unsigned long int;
+  using aig_part = std::tuple<aig_network, std::vector<node>, std::vector<signal>, std::vector<node>>;
 
-  explicit partition_view( aig_network const& ntk, partition_view_params const& ps = {} ) : _hypNum( 0 ), _ps( ps ), _ntk( ntk ), refs( ntk.size() )
+  /*! \brief The hypergraph is only built on first use (e.g., by `create_hypergraph`)
+   * or when it is written out, so extracting blocks of a known partition
+   * does not pay for it.  The first use is not thread-safe.
+   */
+  explicit partition_view( aig_network const& ntk, partition_view_params const& ps = {} ) : _ps( ps ), _ntk( ntk )
   {
-    _sinkHyp.clear();
-    collect_hypgraph( ntk );
-    write_hypgraph( ntk, ps );
+    if ( ps.write_hmetis || ps.write_csr )
+    {
+      build_hypergraph();
+      stopwatch t_write( _st.time_write );
+      if ( ps.write_hmetis )
+      {
+        write_hypgraph( ps );
+      }
+      if ( ps.write_csr )
+      {
+        write_csr_sidecar( ps );
+      }
+    }
   }
 
   ~partition_view()
   {
   }
 
+  /*! \brief Hand the hypergraph to mt-KaHyPar without a file round trip.
+   *
+   * The returned hypergraph is owned by the caller and has to be released
+   * with `mt_kahypar_free_hypergraph`.
+   */
+  mt_kahypar_hypergraph_t create_hypergraph( mt_kahypar_context_t const* context, mt_kahypar_error_t* error ) const
+  {
+    build_hypergraph();
+    return mt_kahypar_create_hypergraph( context, _num_vertices, num_hyperedges(),
+                                         _hyperedge_indices.data(), _hyperedges.data(),
+                                         use_hyperedge_weights() ? _hyperedge_weights.data() : nullptr,
+                                         use_vertex_weights() ? _vertex_weights.data() : nullptr,
+                                         error );
+  }
+
+  mt_kahypar_hypernode_id_t num_vertices() const
+  {
+    build_hypergraph();
+    return _num_vertices;
+  }
+
+  mt_kahypar_hyperedge_id_t num_hyperedges() const
+  {
+    build_hypergraph();
+    return _hyperedge_indices.size() - 1u;
+  }
+
+  /*! \brief Offsets of each hyperedge into `hyperedges()` (size `num_hyperedges() + 1`). */
+  std::vector<size_t> const& hyperedge_indices() const
+  {
+    build_hypergraph();
+    return _hyperedge_indices;
+  }
+
+  /*! \brief Pins of all hyperedges, as zero-based hypernode ids. */
+  std::vector<mt_kahypar_hyperedge_id_t> const& hyperedges() const
+  {
+    build_hypergraph();
+    return _hyperedges;
+  }
+
+  /*! \brief Weight of every hyperedge (only used if hyperedge weights are enabled). */
+  std::vector<mt_kahypar_hyperedge_weight_t> const& hyperedge_weights() const
+  {
+    build_hypergraph();
+    return _hyperedge_weights;
+  }
+
+  /*! \brief Weight of every hypernode (only used if vertex weights are enabled). */
+  std::vector<mt_kahypar_hypernode_weight_t> const& vertex_weights() const
+  {
+    build_hypergraph();
+    return _vertex_weights;
+  }
+
+  /*! \brief Whether `hyperedge_weights()` are handed to the partitioner. */
+  bool use_hyperedge_weights() const
+  {
+    return _ps.si_w_on_hyperedges || _ps.timing_weights;
+  }
+
+  /*! \brief Whether `vertex_weights()` are handed to the partitioner. */
+  bool use_vertex_weights() const
+  {
+    return _ps.si_w_on_vertices || _ps.timing_weights || _ps.max_block_memory != 0u;
+  }
+
+  /*! \brief Estimated peak memory of a block with `gates` under `memory_model`. */
+  uint64_t estimated_memory( std::vector<node> const& gates ) const
+  {
+    return static_cast<uint64_t>( std::ceil( _ps.memory_model.block_bytes( linear_bytes( gates ), gates.size() ) ) );
+  }
+
+  /*! \brief Number of blocks of a flat partition such that every block fits into `max_block_memory`.
+   *
+   * Leaves room for the imbalance `epsilon` of the partitioner.  Returns
+   * `num_blocks` if there is no memory limit.
+   */
+  uint32_t num_blocks_for_memory() const
+  {
+    if ( _ps.max_block_memory == 0u )
+    {
+      return static_cast<uint32_t>( _ps.num_blocks );
+    }
+    std::vector<node> gates;
+    gates.reserve( _ntk.num_gates() );
+    _ntk.foreach_gate( [&]( auto const& n ) {
+      gates.push_back( n );
+    } );
+    return memory_splits( gates, 1.0 + _ps.epsilon );
+  }
+
+  /*! \brief Dense node-to-block vector of an mt-KaHyPar partition.
+   *
+   * Entry `i` holds the block of the node with index `i`, the constant
+   * (which is not a hypernode) is assigned to block -1.
+   */
+  std::vector<block_id> node_to_block( mt_kahypar_partition_id_t const* partition, size_t size ) const
+  {
+    /* the constant may be the last hypernode */
+    size = std::min<size_t>( size, _ntk.size() - 1u );
+    std::vector<block_id> result( size + 1u );
+    result[0] = -1;
+    std::copy( partition, partition + size, result.begin() + 1 );
+    return result;
+  }
+
+  /*! \brief Hierarchy of a recursive partitioning.
+   *
+   * Node 0 is the root, i.e., the whole network, every other node is a
+   * part of its parent.  The leaves are the final blocks: `node_block`
+   * assigns every gate to its leaf block (the constant to block -1), and
+   * the leaves of a subtree have consecutive block ids.
+   */
+  struct partition_tree
+  {
+    struct tree_node
+    {
+      int32_t parent{ -1 };
+      std::vector<uint32_t> children;
+      /* block id of a leaf, -1 for inner nodes */
+      block_id block{ -1 };
+      uint32_t num_gates{ 0u };
+      /* 0 for leaves, otherwise one more than the highest child */
+      uint32_t height{ 0u };
+    };
+
+    std::vector<tree_node> nodes;
+    std::vector<block_id> node_block;
+    uint32_t num_blocks{ 0u };
+
+    /*! \brief Merges all subtrees of at most `height` into single blocks.
+     *
+     * Returns the merged block of every leaf block, merged blocks are
+     * numbered from 0 to `num_merged - 1`.
+     */
+    std::vector<block_id> merge_leaves( uint32_t height, uint32_t& num_merged ) const
+    {
+      std::vector<block_id> merged( num_blocks, -1 );
+      num_merged = 0u;
+      std::vector<uint32_t> stack{ 0u };
+      while ( !stack.empty() )
+      {
+        auto const t = stack.back();
+        stack.pop_back();
+        if ( nodes[t].height > height )
+        {
+          std::for_each( nodes[t].children.rbegin(), nodes[t].children.rend(), [&]( auto const& c ) { stack.push_back( c ); } );
+          continue;
+        }
+        /* all leaves below t */
+        std::vector<uint32_t> sub{ t };
+        while ( !sub.empty() )
+        {
+          auto const u = sub.back();
+          sub.pop_back();
+          if ( nodes[u].children.empty() )
+          {
+            merged[nodes[u].block] = num_merged;
+          }
+          sub.insert( sub.end(), nodes[u].children.begin(), nodes[u].children.end() );
+        }
+        ++num_merged;
+      }
+      return merged;
+    }
+  };
+
+  /*! \brief Splits the network recursively until every block is small enough.
+   *
+   * A part is split into `num_blocks` parts with mt-KaHyPar (fewer if
+   * fewer would do) as long as it has more gates than `max_block_size`
+   * or needs more than `max_block_memory` bytes according to
+   * `memory_model` (see `estimated_memory`).  If neither limit is
+   * set, the network is split once into `num_blocks` blocks.  Returns
+   * `std::nullopt` if mt-KaHyPar fails, `error` holds the reason.
+   *
+   * `mt_kahypar_initialize` must have been called before.
+   */
+  std::optional<partition_tree> partition_recursively( mt_kahypar_error_t* error ) const
+  {
+    build_hypergraph();
+    stopwatch t_partition( _st.time_partition );
+    auto const max_gates = _ps.max_block_size;
+
+    partition_tree tree;
+    tree.nodes.emplace_back();
+    tree.node_block.assign( _ntk.size(), 0 );
+    tree.node_block[0] = -1;
+
+    /* gates of the tree nodes which are not split yet */
+    std::vector<std::vector<node>> pending( 1u );
+    _ntk.foreach_gate( [&]( auto const& n ) {
+      pending[0].push_back( n );
+    } );
+    tree.nodes[0].num_gates = pending[0].size();
+
+    split_scratch scratch;
+    std::vector<mt_kahypar_partition_id_t> assignment;
+    for ( auto t = 0u; t < tree.nodes.size(); ++t )
+    {
+      auto const size = static_cast<uint32_t>( pending[t].size() );
+      uint32_t k = max_gates == 0u ? 1u : ( size + max_gates - 1u ) / max_gates;
+      if ( _ps.max_block_memory != 0u )
+      {
+        k = std::max( k, memory_splits( pending[t], 1.0 ) );
+      }
+      else if ( max_gates == 0u && t == 0u )
+      {
+        k = _ps.num_blocks;
+      }
+      k = std::min<uint32_t>( { k, static_cast<uint32_t>( _ps.num_blocks ), size } );
+      if ( k < 2u )
+      {
+        continue;
+      }
+
+      if ( !split_gates( pending[t], k, scratch, assignment, error ) )
+      {
+        return std::nullopt;
+      }
+
+      /* only keep non-empty parts, stop if the partitioner made no progress */
+      std::vector<std::vector<node>> children( k );
+      for ( auto i = 0u; i < size; ++i )
+      {
+        children[assignment[i]].push_back( pending[t][i] );
+      }
+      if ( std::count_if( children.begin(), children.end(), []( auto const& c ) { return !c.empty(); } ) < 2 )
+      {
+        continue;
+      }
+
+      /* only leaves keep their gates */
+      std::vector<node>().swap( pending[t] );
+      for ( auto& c : children )
+      {
+        if ( c.empty() )
+        {
+          continue;
+        }
+        tree.nodes[t].children.push_back( tree.nodes.size() );
+        tree.nodes.emplace_back();
+        tree.nodes.back().parent = t;
+        tree.nodes.back().num_gates = c.size();
+        pending.emplace_back( std::move( c ) );
+      }
+    }
+
+    /* heights, children are created after their parents */
+    for ( auto t = static_cast<uint32_t>( tree.nodes.size() ); t-- > 1u; )
+    {
+      auto& parent = tree.nodes[tree.nodes[t].parent];
+      parent.height = std::max( parent.height, tree.nodes[t].height + 1u );
+    }
+
+    /* number the leaves in depth-first order */
+    std::vector<uint32_t> stack{ 0u };
+    while ( !stack.empty() )
+    {
+      auto const t = stack.back();
+      stack.pop_back();
+      auto& tn = tree.nodes[t];
+      if ( tn.children.empty() )
+      {
+        tn.block = tree.num_blocks++;
+        for ( auto const& n : pending[t] )
+        {
+          tree.node_block[n] = tn.block;
+        }
+        continue;
+      }
+      std::for_each( tn.children.rbegin(), tn.children.rend(), [&]( auto const& c ) { stack.push_back( c ); } );
+    }
+
+    return tree;
+  }
+
+  /*! \brief Initial hypernode partition derived from the blocks the nodes were created from.
+   *
+   * `node_origin` is the block of every node of this network, e.g., as
+   * returned by `reunite` on the previous network.  Gates without an
+   * origin take the block of their first fanin gate, PIs (and the
+   * constant) the block of their first fanout gate.
+   */
+  std::vector<mt_kahypar_partition_id_t> initial_partition( std::vector<block_id> const& node_origin ) const
+  {
+    build_hypergraph();
+    std::vector<block_id> node_block( _ntk.size(), -1 );
+    _ntk.foreach_gate( [&]( auto const& n ) {
+      node_block[n] = n < node_origin.size() && node_origin[n] >= 0 && node_origin[n] < _ps.num_blocks ? node_origin[n] : -1;
+      _ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        if ( node_block[n] == -1 && _ntk.is_and( _ntk.get_node( fi ) ) )
+        {
+          node_block[n] = node_block[_ntk.get_node( fi )];
+        }
+      } );
+    } );
+    _ntk.foreach_gate( [&]( auto const& n ) {
+      node_block[n] = std::max( node_block[n], 0 );
+      _ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        auto const m = _ntk.get_node( fi );
+        if ( !_ntk.is_and( m ) && node_block[m] == -1 )
+        {
+          node_block[m] = node_block[n];
+        }
+      } );
+    } );
+
+    std::vector<mt_kahypar_partition_id_t> partition( _num_vertices );
+    for ( auto v = 0u; v < _num_vertices; ++v )
+    {
+      /* dangling PIs are spread over all blocks */
+      auto const n = vertex_to_node( v );
+      partition[v] = node_block[n] != -1 ? node_block[n] : static_cast<mt_kahypar_partition_id_t>( v % _ps.num_blocks );
+    }
+    return partition;
+  }
+
+  /*! \brief Refines a previous partition instead of partitioning from scratch.
+   *
+   * The assignment of `initial_partition( node_origin )` is handed to
+   * mt-KaHyPar as initial solution and only improved by refinement
+   * (`num_vcycles` additional V-cycles), which is much cheaper than a new
+   * partition when most of the network is unchanged, e.g., in the next
+   * round of a split-optimize-reunite flow.  The context must be set up
+   * for `num_blocks` blocks.  Returns the dense node-to-block vector, or
+   * `std::nullopt` if mt-KaHyPar fails, `error` holds the reason.
+   */
+  std::optional<std::vector<block_id>> improve_partition( std::vector<block_id> const& node_origin, mt_kahypar_context_t const* context, mt_kahypar_error_t* error, size_t num_vcycles = 0u ) const
+  {
+    build_hypergraph();
+    stopwatch t_partition( _st.time_partition );
+    auto partition = initial_partition( node_origin );
+    mt_kahypar_hypergraph_t hypergraph = create_hypergraph( context, error );
+    if ( hypergraph.hypergraph == nullptr )
+    {
+      return std::nullopt;
+    }
+    mt_kahypar_partitioned_hypergraph_t partitioned_hg = mt_kahypar_create_partitioned_hypergraph( hypergraph, context, _ps.num_blocks, partition.data(), error );
+    if ( partitioned_hg.partitioned_hg == nullptr )
+    {
+      mt_kahypar_free_hypergraph( hypergraph );
+      return std::nullopt;
+    }
+
+    std::optional<std::vector<block_id>> result;
+    if ( mt_kahypar_improve_partition( partitioned_hg, context, num_vcycles, error ) == SUCCESS )
+    {
+      mt_kahypar_get_partition( partitioned_hg, partition.data() );
+      result = node_to_block( partition.data(), partition.size() );
+    }
+    mt_kahypar_free_partitioned_hypergraph( partitioned_hg );
+    mt_kahypar_free_hypergraph( hypergraph );
+    return result;
+  }
+
+  partition_view_params const& params() const
+  {
+    return _ps;
+  }
+
+  /*! \brief The partitioned network. */
+  aig_network const& network() const
+  {
+    return _ntk;
+  }
+
+  /*! \brief Statistics of the view, the runtimes are accumulated over all calls. */
+  partition_view_stats const& stats() const
+  {
+    return _st;
+  }
+
   std::vector<std::tuple<aig_network, std::vector<node>, std::vector<signal>, std::vector<node>>> construct_from_partition( int nPart, const std::unique_ptr<mt_kahypar_partition_id_t[]>& partition, const mt_kahypar_hypergraph_t& hypergraph )
   {
-    auto node_block = convertToMap( partition, mt_kahypar_num_hypernodes( hypergraph ) );
-    // create nPart aig_network in parallel
-    std::vector<std::tuple<aig_network, std::vector<node>, std::vector<signal>, std::vector<node>>> vAigs_win( nPart );
-    // construct aig from scratch
-    /*
-    block0: vCis; vCos; vNodes;
-    block1: vCis; vCos; vNodes;
-    ...
-    */
-    std::vector<std::vector<node>> node_id_split( 3 * nPart );
+    return construct_from_partition( nPart, node_to_block( partition.get(), mt_kahypar_num_hypernodes( hypergraph ) ) );
+  }
 
-    /*
-    For all pis/pos, these can only be split, even after patition, they are still pis/pos, don't need to check the boundaries, just might belongs to different block.
-    */
-    // Deal with constant0 first
+  /*! \brief Boundary of a block: inputs (sorted), outputs (in gate order) and gates (sorted). */
+  struct block_boundary
+  {
+    std::vector<node> inputs;
+    std::vector<signal> outputs;
+    std::vector<node> gates;
+  };
+
+  /*! \brief Computes inputs, outputs and gates of all blocks in O(|V| + |E|).
+   *
+   * Inputs of a block are the fanins of its gates which are not gates of
+   * the same block (PIs, the constant or gates of other blocks), outputs
+   * are the gates referenced outside of the block (by other blocks or
+   * POs).  Gates and inputs are discovered in ascending node order, which
+   * makes them sorted without any extra work.
+   */
+  std::vector<block_boundary> collect_boundaries( int nPart, std::vector<block_id> const& node_block ) const
+  {
     /*
     Eg Inputs 1,2,3 ANDs 4,5,6, then _ntk.num_gates() + _ntk.num_pis() + 1 = 7
     If _ntk.num_gates() + _ntk.num_pis() + 1 means no zero in hMetis
@@ -97,88 +635,215 @@ public:
     Currently not supporting const zero.
     */
     assert( node_block.size() == _ntk.num_gates() + _ntk.num_pis() + 1 );
-    // auto block_id_const = node_block[_ntk.num_gates() + _ntk.num_pis() + 1];
-    // node_id_split[block_id_const * 3].push_back( _ntk.get_node(_ntk.get_constant(false)) );
+    std::vector<block_boundary> blocks( nPart );
+
+    /* gates, references from gates of the same block, and number of blocks reading a node as input */
+    std::vector<uint32_t> block_refs( _ntk.size(), 0u );
+    std::vector<uint32_t> offsets( _ntk.size() + 1u, 0u );
+    _ntk.foreach_gate( [&]( auto const& n ) {
+      auto const b = node_block[n];
+      blocks[b].gates.push_back( n );
+      _ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        if ( is_block_gate( node_block, b, _ntk.get_node( fi ) ) )
+        {
+          block_refs[_ntk.get_node( fi )]++;
+        }
+        else
+        {
+          offsets[_ntk.get_node( fi ) + 1u]++;
+        }
+      } );
+    } );
 
-    _ntk.foreach_pi( [&]( auto const& n_pi ) {
-      auto pi_index = _ntk.node_to_index( n_pi );
-      auto it = node_block.find( pi_index );
-      if ( it == node_block.end() )
+    /* outputs: gates with references outside of their block */
+    _ntk.foreach_gate( [&]( auto const& n ) {
+      if ( _ntk.fanout_size( n ) != block_refs[n] )
       {
-        std::cout << "Something wrong. There's no PI index " << pi_index << std::endl;
+        blocks[node_block[n]].outputs.emplace_back( _ntk.make_signal( n ) );
       }
-      else
+    } );
+
+    /* inputs: bucket the reading blocks by node, then visit the nodes in order */
+    for ( auto i = 1u; i < offsets.size(); ++i )
+    {
+      offsets[i] += offsets[i - 1];
+    }
+    std::vector<block_id> readers( offsets.back() );
+    std::vector<uint32_t> cursor( offsets.begin(), offsets.end() - 1 );
+    _ntk.foreach_gate( [&]( auto const& n ) {
+      auto const b = node_block[n];
+      _ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        if ( !is_block_gate( node_block, b, _ntk.get_node( fi ) ) )
+        {
+          readers[cursor[_ntk.get_node( fi )]++] = b;
+        }
+      } );
+    } );
+    std::vector<node> last_input( nPart, std::numeric_limits<node>::max() );
+    _st.num_cut_hyperedges = 0u;
+    _st.km1 = 0u;
+    for ( node n = 0u; n < _ntk.size(); ++n )
+    {
+      /* connectivity of the hyperedge of `n`, a gate is in its own block */
+      uint32_t lambda = _ntk.is_and( n ) ? 1u : 0u;
+      bool own_block = _ntk.is_and( n );
+      for ( auto i = offsets[n]; i < offsets[n + 1]; ++i )
       {
-        auto block_id = it->second;
-        node_id_split[block_id * 3].push_back( n_pi );
+        if ( last_input[readers[i]] != n )
+        {
+          blocks[readers[i]].inputs.push_back( n );
+          last_input[readers[i]] = n;
+          own_block = own_block || readers[i] == node_block[n];
+          ++lambda;
+        }
       }
-    } );
+      if ( offsets[n] != offsets[n + 1] && !own_block && !_ntk.is_constant( n ) )
+      {
+        ++lambda;
+      }
+      if ( lambda > 1u )
+      {
+        ++_st.num_cut_hyperedges;
+        _st.km1 += lambda - 1u;
+      }
+    }
+
+    uint32_t max_gates = 0u;
+    _st.blocks.resize( nPart );
+    for ( auto b = 0; b < nPart; ++b )
+    {
+      _st.blocks[b] = { static_cast<uint32_t>( blocks[b].gates.size() ), static_cast<uint32_t>( blocks[b].inputs.size() ), static_cast<uint32_t>( blocks[b].outputs.size() ) };
+      max_gates = std::max( max_gates, _st.blocks[b].num_gates );
+    }
+    _st.imbalance = _ntk.num_gates() == 0u ? 0.0 : static_cast<double>( max_gates ) * nPart / _ntk.num_gates() - 1.0;
+
+    return blocks;
+  }
+
+  std::vector<std::tuple<aig_network, std::vector<node>, std::vector<signal>, std::vector<node>>> construct_from_partition( int nPart, std::vector<block_id> const& node_block )
+  {
+    stopwatch t_extract( _st.time_extract );
+    // create nPart aig_network in parallel
+    std::vector<std::tuple<aig_network, std::vector<node>, std::vector<signal>, std::vector<node>>> vAigs_win( nPart );
+
+    /*
+    For all pis/pos, these can only be split, even after patition, they are still pis/pos, don't need to check the boundaries, just might belongs to different block.
+    */
     _ntk.foreach_po( [&]( auto const& n_po ) {
-      auto po_index = _ntk.node_to_index( _ntk.get_node( n_po ) );
       // should be one of the and type or PI type
       assert( _ntk.is_and( _ntk.get_node( n_po ) ) || _ntk.is_pi( _ntk.get_node( n_po ) ) || _ntk.is_constant( _ntk.get_node( n_po ) ) );
-      if ( po_index == 0 )
+      if ( _ntk.node_to_index( _ntk.get_node( n_po ) ) == 0 && _ps.verbose )
       {
         std::cout << "[Warn] PO has const 0." << std::endl;
         /*
         @TODO Jingren Wang
         */
       }
-      else
+    } );
+
+    auto ori_num_gate = _ntk.num_gates();
+    auto blocks = collect_boundaries( nPart, node_block );
+
+    halo_context halo_ctx;
+    _halo_nodes.assign( nPart, {} );
+    _halo_gates.assign( nPart, {} );
+    _halo_windows.assign( nPart, {} );
+    if ( _ps.halo_levels > 0u )
+    {
+      init_halo( halo_ctx, node_block );
+    }
+
+    /*
+    Use window based method to construct a subnetwork and each one of them can be insert back to original aig network and maintain equivalence.
+    Blocks are extracted concurrently, every block only writes its own result slot.
+    */
+    parallel_for( nPart, _ps.num_threads, [&]( uint32_t i, uint32_t tid ) {
+      auto& blk = blocks[i];
+      /* a block may lose all its gates when it is built from an optimized network */
+      assert( blk.gates.empty() || blk.inputs.size() > 0 );
+      assert( blk.gates.empty() || blk.outputs.size() > 0 );
+      aig_network win;
+      if ( _ps.halo_levels > 0u && !blk.gates.empty() )
       {
-        auto it = node_block.find( po_index );
-        if ( it == node_block.end() )
+        auto halo = collect_halo( i, blk, node_block, halo_ctx, halo_ctx.scratch[tid] );
+        clone_subnetwork( _ntk, halo.inputs, halo.outputs, halo.gates, win );
+
+        /* the k-th gate becomes node num_pis + 1 + k, unless the clone merged nodes */
+        if ( win.size() == 1u + halo.inputs.size() + halo.gates.size() )
         {
-          std::cout << "Something wrong. There's no PO index " << po_index << std::endl;
+          for ( auto k = 0u, j = 0u; k < halo.gates.size(); ++k )
+          {
+            if ( j < blk.gates.size() && blk.gates[j] == halo.gates[k] )
+            {
+              ++j;
+              continue;
+            }
+            /* only outputs of other blocks are certain to survive their optimization */
+            if ( halo_ctx.boundary[halo.gates[k]] )
+            {
+              _halo_nodes[i].push_back( static_cast<uint32_t>( 1u + halo.inputs.size() + k ) );
+              _halo_gates[i].push_back( halo.gates[k] );
+            }
+          }
+          _st.blocks[i].num_halo_gates = static_cast<uint32_t>( halo.gates.size() - blk.gates.size() );
+          _halo_windows[i] = window_prefix( win );
+          blk.inputs = std::move( halo.inputs );
         }
         else
         {
-          auto block_id = it->second;
-          node_id_split[block_id * 3 + 1].push_back( _ntk.get_node( n_po ) );
+          win = aig_network();
+          clone_subnetwork( _ntk, blk.inputs, blk.outputs, blk.gates, win );
         }
       }
-    } );
-
-    auto ori_num_gate = _ntk.num_gates();
-    std::cout << "Num of gate in original ntk : " << ori_num_gate << std::endl;
-    _ntk.foreach_gate( [&]( auto const& n_and ) {
-      auto and_index = _ntk.node_to_index( n_and );
-      auto block_id_and = node_block[and_index];
-      auto cis_id = node_id_split[block_id_and * 3];
-      // Do not contain PIs, as suggested by clone_subnetwork api
-      if ( !check_node_exist( cis_id, n_and ) )
+      else
       {
-        assert( _ntk.node_to_index( n_and ) <= _ntk.num_pis() + _ntk.num_gates() );
-        node_id_split[block_id_and * 3 + 2].push_back( n_and );
+        clone_subnetwork( _ntk, blk.inputs, blk.outputs, blk.gates, win );
       }
+      vAigs_win[i] = { win, std::move( blk.inputs ), std::move( blk.outputs ), std::move( blk.gates ) };
     } );
-    std::cout << "Writing out aigs..." << std::endl;
-    /*
-    Use window based method to construct a subnetwork and each one of them can be insert back to original aig network and maintain equivalence
-    */
-    auto count_all_gate = 0;
+
+    uint32_t count_all_gate = 0;
     for ( auto i = 0; i < nPart; i++ )
     {
-      aig_network win;
-      color_view c_ntk{ _ntk };
-      std::vector<node> gates = node_id_split[i * 3 + 2];
-      std::vector<node> inputs_w = collect_inputs( c_ntk, gates );
-      assert( inputs_w.size() > 0 );
-      std::stable_sort( std::begin( inputs_w ), std::end( inputs_w ) );
-      std::stable_sort( std::begin( gates ), std::end( gates ) );
-      std::vector<signal> outputs_w = collect_outputs( c_ntk, inputs_w, gates, refs );
-      assert( outputs_w.size() > 0 );
-      count_all_gate += gates.size();
-      clone_subnetwork( _ntk, inputs_w, outputs_w, gates, win );
-      std::get<0>( vAigs_win[i] ) = win;
-      std::get<1>( vAigs_win[i] ) = inputs_w;
-      std::get<2>( vAigs_win[i] ) = outputs_w;
-      std::get<3>( vAigs_win[i] ) = gates;
+      count_all_gate += std::get<3>( vAigs_win[i] ).size();
     }
     assert( count_all_gate == ori_num_gate );
+    (void)count_all_gate;
     return vAigs_win;
   }
 
+  /*! \brief Nodes of the network of `block` which are outputs of other blocks (last extraction, sorted).
+   *
+   * These halo gates are owned by other blocks and the reunion takes them
+   * from their owners, as long as an optimized block keeps all nodes of
+   * its window at the same index (otherwise its halo is rebuilt from its
+   * own logic).  Only the POs up to the number of block outputs are put
+   * back.
+   */
+  std::vector<uint32_t> const& halo_nodes( uint32_t block ) const
+  {
+    return _halo_nodes[block];
+  }
+
+  /*! \brief Views on all blocks of a partition, without copying their logic.
+   *
+   * Read-only passes can run on the views directly, `materialize` copies a
+   * block into its own network when it is going to be modified.  The
+   * views refer to the network of this partition view.
+   */
+  std::vector<block_view<aig_network>> block_views( int nPart, std::vector<block_id> const& node_block ) const
+  {
+    stopwatch t_extract( _st.time_extract );
+    auto blocks = collect_boundaries( nPart, node_block );
+    std::vector<block_view<aig_network>> views;
+    views.reserve( nPart );
+    for ( auto& blk : blocks )
+    {
+      views.emplace_back( _ntk, std::move( blk.inputs ), std::move( blk.outputs ), std::move( blk.gates ) );
+    }
+    return views;
+  }
+
   void insert_back( std::tuple<aig_network, std::vector<node>, std::vector<signal>, std::vector<node>> const& aig_part )
   {
     auto aig = _ntk;
@@ -194,6 +859,11 @@ public:
     assert( count_reachable_dead_nodes( c_aig ) == 0u );
     insert_ntk( aig, i_sigs.begin(), i_sigs.end(), std::get<0>( aig_part ), [&]( aig_network::signal const& _new ) {
       assert( !c_aig.is_dead( c_aig.get_node( _new ) ) );
+      /* halo outputs are read-only */
+      if ( counter == std::get<2>( aig_part ).size() )
+      {
+        return true;
+      }
       auto const _old = std::get<2>( aig_part ).at( counter++ );
       if ( _old == _new )
       {
@@ -208,155 +878,947 @@ public:
     } );
   }
 
-private:
-  std::map<mt_kahypar_hypernode_id_t, mt_kahypar_partition_id_t> convertToMap(
-      const std::unique_ptr<mt_kahypar_partition_id_t[]>& array,
-      size_t size )
+  /*! \brief Stitches all parts back into a new network in a single pass.
+   *
+   * `parts` are the blocks returned by `construct_from_partition` (same
+   * order), where the network of each block may have been replaced by an
+   * equivalent one with the same PIs and POs.  The final network is
+   * rebuilt from the POs in one depth-first topological pass: block
+   * outputs are taken from the logic of the part, block inputs from the
+   * outputs of the neighbouring parts.  Only logic reachable from the POs
+   * is created, and the original network is not modified.  Strashing may
+   * still simplify a gate whose fanins were already created, e.g., when
+   * two block outputs become the same signal and a gate reads both of
+   * them in opposite polarities; in that case, the gates left without
+   * fanout are removed by a cleanup pass over the result.
+   *
+   * The dependencies of the parts are collected concurrently, every block
+   * filling in its own slice of a table; the nodes are then created in the
+   * same depth-first order for any number of threads.
+   *
+   * If an optimized part depends on an input that closes a combinational
+   * cycle through other blocks, the blocks on that cycle keep their
+   * original logic; they are returned by `rejected_blocks()`.
+   *
+   * If `node_origin` is given, it receives the block every node of the
+   * result was created from (-1 for the constant and the PIs).
+   */
+  aig_network reunite( std::vector<aig_part> const& parts, std::vector<block_id>* node_origin = nullptr )
   {
-    std::map<mt_kahypar_hypernode_id_t, mt_kahypar_partition_id_t> result;
-    result[0] = -1;
-    for ( size_t i = 0; i < size; ++i )
+    stopwatch t_reunite( _st.time_reunite );
+    auto const table = build_reunion_table( parts );
+    std::vector<bool> rejected( parts.size(), false );
+    while ( true )
     {
-      result[i + 1] = array[i];
-    }
-    assert( result.size() == size + 1 );
-    return result;
-  }
-
-  bool check_node_exist( std::vector<node> const& nodes, node const& p )
-  {
-    for ( auto& n : nodes )
-    {
-      if ( n == p )
+      aig_network res;
+      std::vector<block_id> origin;
+      std::vector<block_id> cycle_blocks;
+      if ( reunite_once( parts, table, rejected, res, origin, cycle_blocks ) )
       {
-        return true;
+        _rejected_blocks.clear();
+        for ( auto b = 0u; b < rejected.size(); ++b )
+        {
+          if ( rejected[b] )
+          {
+            _rejected_blocks.push_back( b );
+          }
+        }
+        /* strashing may still merge complementary signals of different blocks */
+        bool dangling = false;
+        res.foreach_gate( [&]( auto const& n ) {
+          dangling = dangling || res.fanout_size( n ) == 0;
+          return !dangling;
+        } );
+        if ( !dangling )
+        {
+          if ( node_origin )
+          {
+            origin.resize( res.size(), -1 );
+            *node_origin = std::move( origin );
+          }
+          return res;
+        }
+        return remove_dangling( res, origin, node_origin );
+      }
+      for ( auto const& b : cycle_blocks )
+      {
+        rejected[b] = true;
       }
     }
-    return false;
   }
 
-  void collect_single_node( fanout_view<aig_network> const& ntk, node const& n )
+  /*! \brief Blocks that kept their original logic in the last `reunite`. */
+  std::vector<block_id> const& rejected_blocks() const
   {
-    _sinkHyp[n] = {};
-    ntk.foreach_fanout( n, [&]( auto const& fo ) {
-      _sinkHyp[n].push_back( fo );
-    } );
+    return _rejected_blocks;
   }
 
-  void collect_hypgraph( aig_network const& ntk )
+private:
+  /* Items of the reunion are the nodes of the original network, followed by the nodes of all parts.
+     The dependencies of every item are encoded as literals 2 * item + complemented. */
+  struct reunion_table
   {
-    fanout_view f_aig{ ntk };
-    // don't need to consider this since mt doesn't create new node for PO
-    if ( !_ps.skip_po_as_sink )
+    static constexpr uint64_t none = std::numeric_limits<uint64_t>::max();
+
+    std::vector<uint64_t> base;
+    std::vector<block_id> owner;
+    std::vector<std::array<uint64_t, 2u>> children;
+  };
+
+  /* the dependencies of all items, every block fills in its own gates and its part */
+  reunion_table build_reunion_table( std::vector<aig_part> const& parts ) const
+  {
+    auto const num_nodes = _ntk.size();
+    reunion_table table;
+    table.base.resize( parts.size() + 1u );
+    table.base[0] = num_nodes;
+    for ( auto b = 0u; b < parts.size(); ++b )
     {
+      table.base[b + 1] = table.base[b] + std::get<0>( parts[b] ).size();
+      assert( std::get<0>( parts[b] ).num_pis() == std::get<1>( parts[b] ).size() );
+      /* POs after the block outputs expose halo gates */
+      assert( std::get<0>( parts[b] ).num_pos() >= std::get<2>( parts[b] ).size() );
     }
-    ntk.foreach_pi( [&]( auto pi ) {
-      collect_single_node( f_aig, pi );
-    } );
-    ntk.foreach_node( [&]( auto node ) {
-      collect_single_node( f_aig, node );
+    table.owner.assign( num_nodes, -1 );
+    table.children.resize( table.base.back(), { reunion_table::none, reunion_table::none } );
+    bool const use_halo = _halo_nodes.size() == parts.size();
+
+    parallel_for( static_cast<uint32_t>( parts.size() ), _ps.num_threads, [&]( uint32_t b, uint32_t ) {
+      auto const& part = std::get<0>( parts[b] );
+      auto const& inputs = std::get<1>( parts[b] );
+      auto const& outputs = std::get<2>( parts[b] );
+      for ( auto const& g : std::get<3>( parts[b] ) )
+      {
+        table.owner[g] = b;
+        _ntk.foreach_fanin( g, [&]( auto const& fi, auto i ) {
+          table.children[g][i] = 2u * _ntk.get_node( fi ) + ( _ntk.is_complemented( fi ) ? 1u : 0u );
+        } );
+      }
+      /* block outputs are taken from the logic of the part */
+      for ( auto j = 0u; j < outputs.size(); ++j )
+      {
+        auto const po = part.po_at( j );
+        table.children[_ntk.get_node( outputs[j] )] = { 2u * ( table.base[b] + part.get_node( po ) ) + ( part.is_complemented( po ) != outputs[j].complement ? 1u : 0u ), reunion_table::none };
+      }
+
+      auto* const slice = &table.children[table.base[b]];
+      part.foreach_pi( [&]( auto const& n, auto i ) {
+        slice[n][0] = 2u * inputs[i];
+      } );
+      part.foreach_gate( [&]( auto const& n ) {
+        part.foreach_fanin( n, [&]( auto const& fi, auto i ) {
+          slice[n][i] = 2u * ( table.base[b] + part.get_node( fi ) ) + ( part.is_complemented( fi ) ? 1u : 0u );
+        } );
+      } );
+      /* halo nodes stand for the original gates, as long as the nodes of the window kept their index and fanins */
+      if ( use_halo && !_halo_nodes[b].empty() && has_window_prefix( part, _halo_windows[b] ) )
+      {
+        for ( auto k = 0u; k < _halo_nodes[b].size(); ++k )
+        {
+          if ( _halo_nodes[b][k] < part.size() )
+          {
+            slice[_halo_nodes[b][k]] = { 2u * _halo_gates[b][k], reunion_table::none };
+          }
+        }
+      }
     } );
-    std::vector<node> copy = _sinkHyp[0];
-    auto last_index = _sinkHyp.size();
-    _sinkHyp[0] = {};
-    _sinkHyp[last_index] = copy;
+    return table;
+  }
+
+  /* number of PIs, number of nodes and the fanin literals of all gates of a window */
+  static std::vector<uint64_t> window_prefix( aig_network const& win )
+  {
+    std::vector<uint64_t> prefix{ win.num_pis(), win.size() };
+    prefix.reserve( 2u + 2u * win.num_gates() );
+    for ( auto n = win.num_pis() + 1u; n < win.size(); ++n )
+    {
+      win.foreach_fanin( win.index_to_node( n ), [&]( auto const& fi ) {
+        prefix.push_back( 2u * win.node_to_index( win.get_node( fi ) ) + ( win.is_complemented( fi ) ? 1u : 0u ) );
+      } );
+    }
+    return prefix;
+  }
+
+  /* whether the first nodes of `part` are exactly the window described by `prefix` */
+  static bool has_window_prefix( aig_network const& part, std::vector<uint64_t> const& prefix )
+  {
+    if ( prefix.size() < 2u || part.num_pis() != prefix[0] || part.size() < prefix[1] )
+    {
+      return false;
+    }
+    auto k = 2u;
+    bool equal = true;
+    for ( auto n = part.num_pis() + 1u; n < prefix[1] && equal; ++n )
+    {
+      part.foreach_fanin( part.index_to_node( n ), [&]( auto const& fi ) {
+        equal = equal && k < prefix.size() && prefix[k++] == 2u * part.node_to_index( part.get_node( fi ) ) + ( part.is_complemented( fi ) ? 1u : 0u );
+      } );
+    }
+    return equal && k == prefix.size();
   }
 
-  void hypNumCount( std::map<node, std::vector<node>> const& allHyp, int& hypNum )
+  bool reunite_once( std::vector<aig_part> const& parts, reunion_table const& table, std::vector<bool> const& rejected, aig_network& res, std::vector<block_id>& origin, std::vector<block_id>& cycle_blocks ) const
   {
-    for ( auto& item : allHyp )
+    auto const num_nodes = _ntk.size();
+    auto const& base = table.base;
+    auto const& owner = table.owner;
+
+    /* the result is about as large as the original network, avoid growing the hash table */
+    res._storage->nodes.reserve( num_nodes + num_nodes / 4u );
+    res._storage->hash.reserve( num_nodes + num_nodes / 4u );
+
+    /* 0: not visited, 1: on the stack, 2: done */
+    std::vector<uint8_t> state( base.back(), 0u );
+    std::vector<signal> value( base.back() );
+    value[0] = res.get_constant( false );
+    state[0] = 2u;
+    _ntk.foreach_pi( [&]( auto const& n ) {
+      value[n] = res.create_pi();
+      state[n] = 2u;
+    } );
+    for ( auto b = 0u; b < parts.size(); ++b )
     {
-      if ( item.second.size() > 0 )
+      value[base[b]] = res.get_constant( false );
+      state[base[b]] = 2u;
+    }
+
+    auto block_of_item = [&]( uint64_t item ) -> block_id {
+      return static_cast<block_id>( std::upper_bound( base.begin(), base.end(), item ) - base.begin() ) - 1;
+    };
+    auto is_output = [&]( uint64_t item ) {
+      return table.children[item][1] == reunion_table::none && table.children[item][0] / 2u >= num_nodes;
+    };
+
+    /* dependencies of an item; gates of rejected blocks keep their original fanins */
+    std::array<uint64_t, 2u> children;
+    auto fetch_children = [&]( uint64_t item ) -> uint32_t {
+      if ( item < num_nodes && ( owner[item] < 0 || rejected[owner[item]] ) )
       {
-        hypNum++;
+        _ntk.foreach_fanin( item, [&]( auto const& fi, auto i ) {
+          children[i] = 2u * _ntk.get_node( fi ) + ( _ntk.is_complemented( fi ) ? 1u : 0u );
+        } );
+        return 2u;
       }
+      children = table.children[item];
+      return children[1] == reunion_table::none ? 1u : 2u;
+    };
+
+    /* iterative DFS, creates an item in post-order */
+    std::vector<std::pair<uint64_t, uint32_t>> stack;
+    auto resolve = [&]( uint64_t root ) {
+      if ( state[root] == 2u )
+      {
+        return true;
+      }
+      state[root] = 1u;
+      stack.emplace_back( root, 0u );
+      while ( !stack.empty() )
+      {
+        auto const item = stack.back().first;
+        auto const num_children = fetch_children( item );
+        if ( stack.back().second < num_children )
+        {
+          auto const child = children[stack.back().second++] / 2u;
+          if ( state[child] == 0u )
+          {
+            state[child] = 1u;
+            stack.emplace_back( child, 0u );
+          }
+          else if ( state[child] == 1u )
+          {
+            /* every cycle passes through a part, the original network is acyclic */
+            for ( auto it = stack.rbegin(); it != stack.rend(); ++it )
+            {
+              auto const b = it->first < num_nodes ? owner[it->first] : block_of_item( it->first );
+              if ( b >= 0 && ( it->first >= num_nodes || is_output( it->first ) ) )
+              {
+                cycle_blocks.push_back( b );
+              }
+              if ( it->first == child )
+              {
+                break;
+              }
+            }
+            stack.clear();
+            return false;
+          }
+          continue;
+        }
+
+        if ( num_children == 1u )
+        {
+          value[item] = value[children[0] / 2u] ^ ( children[0] & 1u );
+        }
+        else
+        {
+          value[item] = res.create_and( value[children[0] / 2u] ^ ( children[0] & 1u ), value[children[1] / 2u] ^ ( children[1] & 1u ) );
+          auto const created = res.get_node( value[item] );
+          if ( created >= origin.size() )
+          {
+            origin.resize( created + 1u, -1 );
+            origin[created] = item < num_nodes ? owner[item] : block_of_item( item );
+          }
+        }
+        state[item] = 2u;
+        stack.pop_back();
+      }
+      return true;
+    };
+
+    bool acyclic = true;
+    std::vector<signal> pos;
+    _ntk.foreach_po( [&]( auto const& f ) {
+      acyclic = resolve( _ntk.get_node( f ) );
+      pos.push_back( value[_ntk.get_node( f )] ^ _ntk.is_complemented( f ) );
+      return acyclic;
+    } );
+    if ( !acyclic )
+    {
+      return false;
+    }
+    for ( auto const& f : pos )
+    {
+      res.create_po( f );
     }
+    return true;
   }
 
-  void write_hypgraph( aig_network const& ntk, partition_view_params ps )
+  /* cleanup_dangling which keeps track of the node origins */
+  aig_network remove_dangling( aig_network const& res, std::vector<block_id> const& origin, std::vector<block_id>* node_origin ) const
   {
-    // skip the weight simulation for now
-    std::ofstream os( ps.file_name.c_str(), std::ofstream::out );
-    hypNumCount( _sinkHyp, _hypNum );
-    bool constExist = false;
-    if ( _sinkHyp[_sinkHyp.size() - 1].size() == 0 )
+    aig_network dest;
+    std::vector<signal> cis;
+    detail::clone_inputs( res, dest, cis );
+    node_map<signal, aig_network> old_to_new( res );
+    detail::cleanup_dangling_impl( res, dest, cis.begin(), cis.end(), old_to_new );
+    detail::clone_outputs( res, dest, old_to_new );
+
+    if ( node_origin )
     {
-      os << _hypNum << " " << ntk.num_gates() + ntk.num_pis();
+      node_origin->assign( dest.size(), -1 );
+      res.foreach_gate( [&]( auto const& n ) {
+        /* unreachable gates keep the default signal, i.e., the constant */
+        auto const m = dest.get_node( old_to_new[n] );
+        if ( dest.is_and( m ) && ( *node_origin )[m] == -1 && n < origin.size() )
+        {
+          ( *node_origin )[m] = origin[n];
+        }
+      } );
     }
-    else
+    return dest;
+  }
+
+  /* estimated bytes of `gates` without the fixed and superlinear terms of the model */
+  double linear_bytes( std::vector<node> const& gates ) const
+  {
+    double bytes = 0.0;
+    for ( auto const& n : gates )
     {
-      os << _hypNum << " " << ntk.num_gates() + ntk.num_pis() + 1;
-      constExist = true;
+      bytes += _ps.memory_model.gate_bytes( _ntk.fanout_size( n ) );
     }
+    return bytes;
+  }
 
-    if ( ps.si_w_on_hyperedges && ps.si_w_on_vertices )
+  /* number of parts such that parts of `slack` times the average size fit into `max_block_memory` */
+  uint32_t memory_splits( std::vector<node> const& gates, double slack ) const
+  {
+    if ( gates.empty() )
     {
-      os << " " << 11;
+      return 1u;
     }
-    else if ( ps.si_w_on_hyperedges )
+    auto const average = linear_bytes( gates ) / gates.size();
+    auto const max_gates = static_cast<double>( _ps.memory_model.max_gates( average, _ps.max_block_memory ) );
+    auto const k = std::ceil( slack * gates.size() / max_gates );
+    return static_cast<uint32_t>( std::min<double>( k, std::numeric_limits<uint32_t>::max() ) );
+  }
+
+  node vertex_to_node( mt_kahypar_hypernode_id_t v ) const
+  {
+    return _const_vertex && v + 1u == _num_vertices ? 0u : static_cast<node>( v + 1u );
+  }
+
+  /* reusable scratch memory of `split_gates` */
+  struct split_scratch
+  {
+    std::vector<uint32_t> local;
+    std::vector<edge_id> edge_of;
+    std::vector<uint32_t> seen;
+    uint32_t stamp{ 0u };
+  };
+
+  /* partitions the sub-hypergraph induced by `gates` into `k` parts */
+  bool split_gates( std::vector<node> const& gates, uint32_t k, split_scratch& scratch, std::vector<mt_kahypar_partition_id_t>& assignment, mt_kahypar_error_t* error ) const
+  {
+    auto const size = static_cast<uint32_t>( gates.size() );
+    assignment.assign( size, 0 );
+
+    if ( scratch.edge_of.empty() )
     {
-      os << " " << 1;
+      scratch.local.assign( _ntk.size(), std::numeric_limits<uint32_t>::max() );
+      scratch.edge_of.assign( _ntk.size(), std::numeric_limits<edge_id>::max() );
+      for ( edge_id e = 0; e < num_hyperedges(); ++e )
+      {
+        scratch.edge_of[vertex_to_node( _hyperedges[_hyperedge_indices[e]] )] = e;
+      }
+      scratch.seen.assign( num_hyperedges(), 0u );
     }
-    else if ( ps.si_w_on_vertices )
+    auto& local = scratch.local;
+    auto const stamp = ++scratch.stamp;
+
+    /* local ids of the gates */
+    for ( auto i = 0u; i < size; ++i )
     {
-      os << " " << 10;
+      local[gates[i]] = i;
     }
-    os << "\n";
 
-    for ( auto item = _sinkHyp.begin(); item != _sinkHyp.end(); item++ )
+    /* hyperedges touching the gates: their own ones and the ones of their fanins */
+    std::vector<size_t> indices{ 0u };
+    std::vector<mt_kahypar_hyperedge_id_t> pins;
+    std::vector<mt_kahypar_hyperedge_weight_t> weights;
+    auto add_hyperedge = [&]( node const& n ) {
+      auto const e = scratch.edge_of[n];
+      if ( e == std::numeric_limits<edge_id>::max() || scratch.seen[e] == stamp )
+      {
+        return;
+      }
+      scratch.seen[e] = stamp;
+      for ( auto i = _hyperedge_indices[e]; i < _hyperedge_indices[e + 1]; ++i )
+      {
+        auto const m = vertex_to_node( _hyperedges[i] );
+        if ( local[m] != std::numeric_limits<uint32_t>::max() )
+        {
+          pins.push_back( local[m] );
+        }
+      }
+      if ( pins.size() - indices.back() < 2u )
+      {
+        pins.resize( indices.back() );
+        return;
+      }
+      indices.push_back( pins.size() );
+      weights.push_back( _hyperedge_weights[e] );
+    };
+    std::vector<mt_kahypar_hypernode_weight_t> vertex_weights;
+    for ( auto const& n : gates )
+    {
+      vertex_weights.push_back( _vertex_weights[n - 1u] );
+      add_hyperedge( n );
+      _ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        add_hyperedge( _ntk.get_node( fi ) );
+      } );
+    }
+    for ( auto const& n : gates )
     {
+      local[n] = std::numeric_limits<uint32_t>::max();
+    }
 
-      if ( item->second.size() == 0 )
+    if ( pins.empty() )
+    {
+      /* nothing connects the gates, any balanced split is optimal */
+      for ( auto i = 0u; i < size; ++i )
       {
-        continue;
+        assignment[i] = static_cast<mt_kahypar_partition_id_t>( uint64_t( i ) * k / size );
       }
-      else
+      return true;
+    }
+
+    mt_kahypar_context_t* context = mt_kahypar_context_from_preset( DETERMINISTIC );
+    mt_kahypar_set_partitioning_parameters( context, k, _ps.epsilon, KM1 );
+    mt_kahypar_set_seed( _ps.seed );
+    mt_kahypar_set_context_parameter( context, VERBOSE, "0", error );
+
+    mt_kahypar_hypergraph_t hypergraph = mt_kahypar_create_hypergraph( context, size, indices.size() - 1u, indices.data(), pins.data(),
+                                                                       use_hyperedge_weights() ? weights.data() : nullptr,
+                                                                       use_vertex_weights() ? vertex_weights.data() : nullptr, error );
+    if ( hypergraph.hypergraph == nullptr )
+    {
+      mt_kahypar_free_context( context );
+      return false;
+    }
+    mt_kahypar_partitioned_hypergraph_t partitioned_hg = mt_kahypar_partition( hypergraph, context, error );
+    if ( partitioned_hg.partitioned_hg == nullptr )
+    {
+      mt_kahypar_free_hypergraph( hypergraph );
+      mt_kahypar_free_context( context );
+      return false;
+    }
+    mt_kahypar_get_partition( partitioned_hg, assignment.data() );
+
+    mt_kahypar_free_partitioned_hypergraph( partitioned_hg );
+    mt_kahypar_free_hypergraph( hypergraph );
+    mt_kahypar_free_context( context );
+    return true;
+  }
+
+  /* gate readers of every node, and per-thread marks of `collect_halo` (valid if equal to the block id plus one) */
+  struct halo_context
+  {
+    struct marks
+    {
+      std::vector<uint32_t> window;
+      std::vector<uint32_t> visited;
+      std::vector<uint8_t> depends;
+      std::vector<uint32_t> read;
+    };
+
+    std::vector<uint32_t> fanout_indices;
+    std::vector<node> fanouts;
+    /* gates which are outputs of their block */
+    std::vector<uint8_t> boundary;
+    std::vector<marks> scratch;
+  };
+
+  void init_halo( halo_context& ctx, std::vector<block_id> const& node_block ) const
+  {
+    ctx.boundary.assign( _ntk.size(), 0u );
+    _ntk.foreach_po( [&]( auto const& f ) {
+      ctx.boundary[_ntk.get_node( f )] = 1u;
+    } );
+    ctx.fanout_indices.assign( _ntk.size() + 1u, 0u );
+    _ntk.foreach_gate( [&]( auto const& n ) {
+      _ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        ctx.fanout_indices[_ntk.get_node( fi ) + 1u]++;
+      } );
+    } );
+    std::partial_sum( ctx.fanout_indices.begin(), ctx.fanout_indices.end(), ctx.fanout_indices.begin() );
+    ctx.fanouts.resize( ctx.fanout_indices.back() );
+    std::vector<uint32_t> cursor( ctx.fanout_indices.begin(), ctx.fanout_indices.end() - 1 );
+    _ntk.foreach_gate( [&]( auto const& n ) {
+      _ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        ctx.fanouts[cursor[_ntk.get_node( fi )]++] = n;
+        if ( node_block[_ntk.get_node( fi )] != node_block[n] )
+        {
+          ctx.boundary[_ntk.get_node( fi )] = 1u;
+        }
+      } );
+    } );
+
+    ctx.scratch.resize( resolve_num_threads( _ps.num_threads ) );
+    for ( auto& sc : ctx.scratch )
+    {
+      sc.window.assign( _ntk.size(), 0u );
+      sc.visited.assign( _ntk.size(), 0u );
+      sc.depends.assign( _ntk.size(), 0u );
+      sc.read.assign( _ntk.size(), 0u );
+    }
+  }
+
+  /* window of block `b` with `halo_levels` levels of context: all its inputs (sorted),
+     the block outputs followed by the halo gates nothing in the window reads, and
+     the block and halo gates (sorted) */
+  block_boundary collect_halo( uint32_t b, block_boundary const& blk, std::vector<block_id> const& node_block, halo_context const& ctx, halo_context::marks& sc ) const
+  {
+    auto const stamp = b + 1u;
+    auto in_window = [&]( node const& n ) { return sc.window[n] == stamp; };
+    for ( auto const& g : blk.gates )
+    {
+      sc.window[g] = stamp;
+    }
+
+    /* whether `n` depends on a gate of the block; node indices are topologically
+       sorted, so nodes before the first gate of the block cannot */
+    auto const first_gate = blk.gates.front();
+    std::vector<node> stack;
+    auto depends_on_block = [&]( node const& root ) {
+      stack.assign( 1u, root );
+      while ( !stack.empty() )
       {
-        if ( ps.si_w_on_hyperedges )
+        auto const n = stack.back();
+        if ( sc.visited[n] == stamp )
         {
-          // This could be customized, currently use the fanout number as the weight
-          os << item->second.size() << " ";
+          stack.pop_back();
+          continue;
         }
-        os << ntk.node_to_index( item->first ) << " ";
-        for ( auto t = item->second.begin(); t < item->second.end(); t++ )
+        if ( n < first_gate || !_ntk.is_and( n ) )
         {
-          if ( t == item->second.end() - 1 )
+          sc.visited[n] = stamp;
+          sc.depends[n] = 0u;
+          stack.pop_back();
+          continue;
+        }
+        if ( node_block[n] == static_cast<block_id>( b ) )
+        {
+          sc.visited[n] = stamp;
+          sc.depends[n] = 1u;
+          stack.pop_back();
+          continue;
+        }
+        bool pending = false, depends = false;
+        _ntk.foreach_fanin( n, [&]( auto const& fi ) {
+          auto const m = _ntk.get_node( fi );
+          if ( sc.visited[m] != stamp )
           {
-            os << ntk.node_to_index( *t ) << "\n";
+            stack.push_back( m );
+            pending = true;
           }
           else
           {
-            os << ntk.node_to_index( *t ) << " ";
+            depends = depends || sc.depends[m];
           }
+        } );
+        if ( !pending )
+        {
+          sc.visited[n] = stamp;
+          sc.depends[n] = depends ? 1u : 0u;
+          stack.pop_back();
         }
       }
+      return sc.depends[root] != 0u;
+    };
+
+    block_boundary halo;
+    std::vector<node> halo_gates;
+
+    /* fanin context: gates feeding the block which do not depend on it,
+       otherwise the window would hide a path through the block */
+    std::vector<node> frontier, next;
+    for ( auto const& n : blk.inputs )
+    {
+      if ( _ntk.is_and( n ) )
+      {
+        frontier.push_back( n );
+      }
     }
-    // simulate weights of vertices to 1, which could be modified
-    if ( ps.si_w_on_vertices )
+    for ( auto level = 0u; level < _ps.halo_levels && !frontier.empty(); ++level )
     {
-      for ( auto item = _sinkHyp.begin(); item != _sinkHyp.end(); item++ )
+      next.clear();
+      for ( auto const& h : frontier )
       {
-        if ( item->second.size() == 0 )
+        if ( in_window( h ) || depends_on_block( h ) )
         {
           continue;
         }
-        os << 1 << "\n";
+        sc.window[h] = stamp;
+        halo_gates.push_back( h );
+        _ntk.foreach_fanin( h, [&]( auto const& fi ) {
+          if ( _ntk.is_and( _ntk.get_node( fi ) ) && !in_window( _ntk.get_node( fi ) ) )
+          {
+            next.push_back( _ntk.get_node( fi ) );
+          }
+        } );
+      }
+      std::swap( frontier, next );
+    }
+
+    /* fanout context: readers of the window whose other fanins are in the window
+       or do not depend on the block */
+    auto const num_fanin_halo = halo_gates.size();
+    frontier.clear();
+    for ( auto const& o : blk.outputs )
+    {
+      frontier.push_back( _ntk.get_node( o ) );
+    }
+    for ( auto level = 0u; level < _ps.halo_levels && !frontier.empty(); ++level )
+    {
+      next.clear();
+      for ( auto const& g : frontier )
+      {
+        for ( auto i = ctx.fanout_indices[g]; i < ctx.fanout_indices[g + 1u]; ++i )
+        {
+          auto const r = ctx.fanouts[i];
+          if ( in_window( r ) )
+          {
+            continue;
+          }
+          bool closed = true;
+          _ntk.foreach_fanin( r, [&]( auto const& fi ) {
+            closed = closed && ( in_window( _ntk.get_node( fi ) ) || !depends_on_block( _ntk.get_node( fi ) ) );
+          } );
+          if ( closed )
+          {
+            sc.window[r] = stamp;
+            halo_gates.push_back( r );
+            next.push_back( r );
+          }
+        }
+      }
+      std::swap( frontier, next );
+    }
+
+    /* the reunion keeps only PIs and block outputs of the original network, so
+       halo gates reading other nodes outside of the window are dropped again
+       (in topological order, a dropped gate may be read by later ones) */
+    std::vector<node> sorted_halo( halo_gates );
+    std::sort( sorted_halo.begin(), sorted_halo.end() );
+    for ( auto const& h : sorted_halo )
+    {
+      _ntk.foreach_fanin( h, [&]( auto const& fi ) {
+        auto const m = _ntk.get_node( fi );
+        if ( !in_window( m ) && _ntk.is_and( m ) && ( !ctx.boundary[m] || depends_on_block( m ) ) )
+        {
+          sc.window[h] = 0u;
+        }
+      } );
+    }
+    auto const num_kept_fanin = std::count_if( halo_gates.begin(), halo_gates.begin() + num_fanin_halo, in_window );
+    halo_gates.erase( std::remove_if( halo_gates.begin(), halo_gates.end(), [&]( auto const& h ) { return !in_window( h ); } ), halo_gates.end() );
+
+    /* gates, inputs, and the fanout context nothing in the window reads */
+    halo.gates = blk.gates;
+    halo.gates.insert( halo.gates.end(), halo_gates.begin(), halo_gates.end() );
+    std::sort( halo.gates.begin(), halo.gates.end() );
+    for ( auto const& g : halo.gates )
+    {
+      _ntk.foreach_fanin( g, [&]( auto const& fi ) {
+        auto const m = _ntk.get_node( fi );
+        if ( in_window( m ) )
+        {
+          sc.read[m] = stamp;
+        }
+        else
+        {
+          halo.inputs.push_back( m );
+        }
+      } );
+    }
+    std::sort( halo.inputs.begin(), halo.inputs.end() );
+    halo.inputs.erase( std::unique( halo.inputs.begin(), halo.inputs.end() ), halo.inputs.end() );
+    halo.outputs = blk.outputs;
+    for ( auto i = static_cast<size_t>( num_kept_fanin ); i < halo_gates.size(); ++i )
+    {
+      if ( sc.read[halo_gates[i]] != stamp )
+      {
+        halo.outputs.push_back( _ntk.make_signal( halo_gates[i] ) );
+      }
+    }
+    return halo;
+  }
+
+  bool is_block_gate( std::vector<block_id> const& node_block, block_id b, node const& n ) const
+  {
+    return !_ntk.is_constant( n ) && !_ntk.is_ci( n ) && node_block[n] == b;
+  }
+
+  /* hyperedge of a node: the node itself followed by its gate fanouts;
+     hypernode ids are zero-based, i.e., the hMetis vertex id minus one */
+  void build_hypergraph() const
+  {
+    if ( !_hypergraph_built )
+    {
+      _hypergraph_built = true;
+      stopwatch t_build( _st.time_build );
+      collect_hypgraph( _ntk );
+    }
+  }
+
+  void collect_hypgraph( aig_network const& ntk ) const
+  {
+    // don't need to consider this since mt doesn't create new node for PO
+    if ( !_ps.skip_po_as_sink )
+    {
+    }
+    std::vector<uint32_t> num_fanouts( ntk.size(), 0u );
+    ntk.foreach_gate( [&]( auto const& n ) {
+      ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        num_fanouts[ntk.get_node( fi )]++;
+      } );
+    } );
+
+    /* offsets, the const zero (if used) goes last as the largest index */
+    _num_vertices = ntk.num_gates() + ntk.num_pis();
+    _const_vertex = num_fanouts[0] > 0;
+    std::vector<size_t> cursor( ntk.size(), 0u );
+    _hyperedge_indices.assign( 1u, 0u );
+    _hyperedge_weights.clear();
+    auto add_offset = [&]( node const& n ) {
+      if ( num_fanouts[n] == 0 )
+      {
+        return;
+      }
+      cursor[n] = _hyperedge_indices.back() + 1u;
+      _hyperedge_indices.push_back( _hyperedge_indices.back() + 1u + num_fanouts[n] );
+      _hyperedge_weights.push_back( static_cast<mt_kahypar_hyperedge_weight_t>( num_fanouts[n] ) );
+    };
+    ntk.foreach_node( [&]( auto const& n ) {
+      if ( !ntk.is_constant( n ) )
+      {
+        add_offset( n );
+      }
+    } );
+    add_offset( 0 );
+
+    /* pins */
+    _hyperedges.resize( _hyperedge_indices.back() );
+    ntk.foreach_node( [&]( auto const& n ) {
+      if ( num_fanouts[n] > 0 )
+      {
+        _hyperedges[cursor[n] - 1u] = ntk.is_constant( n ) ? _num_vertices : ntk.node_to_index( n ) - 1u;
       }
+    } );
+    ntk.foreach_gate( [&]( auto const& n ) {
+      ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        _hyperedges[cursor[ntk.get_node( fi )]++] = ntk.node_to_index( n ) - 1u;
+      } );
+    } );
+
+    if ( _const_vertex )
+    {
+      ++_num_vertices;
     }
-    os << "%% Mockturtle finished writing the hMetis file." << std::endl;
-    if ( constExist )
+    _vertex_weights.assign( _num_vertices, 1 );
+
+    if ( _ps.timing_weights )
+    {
+      compute_timing_weights( ntk, num_fanouts );
+    }
+    if ( _ps.max_block_memory != 0u )
     {
-      // This should not be triggered currently without const zero.
-      assert( 0 );
-      os << "%% Const exists as the largest index." << std::endl;
+      compute_memory_weights( ntk );
     }
+  }
+
+  /* vertex weights proportional to the estimated bytes of the gates, a gate without fanouts weighs 16 */
+  void compute_memory_weights( aig_network const& ntk ) const
+  {
+    auto const unit = std::max( 1.0, _ps.memory_model.gate_bytes( 0u ) / 16.0 );
+    ntk.foreach_gate( [&]( auto const& n ) {
+      auto const w = std::ceil( _ps.memory_model.gate_bytes( ntk.fanout_size( n ) ) / unit );
+      _vertex_weights[n - 1u] = static_cast<mt_kahypar_hypernode_weight_t>( std::min<double>( w, std::numeric_limits<int32_t>::max() / std::max<uint32_t>( _num_vertices, 1u ) ) );
+    } );
+  }
+
+  /* hyperedge weights from the slack of the source node, vertex weights from criticality */
+  void compute_timing_weights( aig_network const& ntk, std::vector<uint32_t> const& num_fanouts ) const
+  {
+    depth_view<aig_network> d_ntk{ ntk };
+    auto const depth = d_ntk.depth();
+
+    /* required levels, node indices are topologically sorted */
+    std::vector<uint32_t> required( ntk.size(), depth );
+    for ( auto i = static_cast<uint32_t>( ntk.size() ); i-- > 0u; )
+    {
+      auto const n = ntk.index_to_node( i );
+      if ( !ntk.is_and( n ) )
+      {
+        continue;
+      }
+      ntk.foreach_fanin( n, [&]( auto const& fi ) {
+        auto& r = required[ntk.get_node( fi )];
+        r = std::min( r, required[n] - 1u );
+      } );
+    }
+
+    /* weights grow quadratically with the criticality ( depth - slack ) / depth */
+    auto const extra = static_cast<uint64_t>( std::max( _ps.critical_weight, 1u ) - 1u );
+    auto timing_weight = [&]( node const& n ) {
+      if ( depth == 0u )
+      {
+        return static_cast<mt_kahypar_hyperedge_weight_t>( extra + 1u );
+      }
+      uint64_t const criticality = depth - ( required[n] - d_ntk.level( n ) );
+      return static_cast<mt_kahypar_hyperedge_weight_t>( 1u + extra * criticality * criticality / ( uint64_t( depth ) * depth ) );
+    };
+
+    edge_id e = 0u;
+    auto assign = [&]( node const& n ) {
+      if ( num_fanouts[n] > 0 )
+      {
+        _hyperedge_weights[e++] = timing_weight( n );
+      }
+    };
+    ntk.foreach_node( [&]( auto const& n ) {
+      if ( !ntk.is_constant( n ) )
+      {
+        assign( n );
+      }
+    } );
+    assign( 0 );
+    assert( e == num_hyperedges() );
+
+    ntk.foreach_node( [&]( auto const& n ) {
+      if ( !ntk.is_constant( n ) )
+      {
+        _vertex_weights[n - 1u] = required[n] == d_ntk.level( n ) ? 2 : 1;
+      }
+    } );
+  }
+
+  void write_hypgraph( partition_view_params const& ps ) const
+  {
+    build_hypergraph();
+    std::ofstream os( ps.file_name.c_str(), std::ofstream::out | std::ofstream::binary );
+
+    /* format into a memory buffer, write it out in large chunks */
+    constexpr size_t chunk_size = 1u << 20;
+    fmt::memory_buffer buffer;
+    auto flush = [&]( bool force ) {
+      if ( force || buffer.size() >= chunk_size )
+      {
+        os.write( buffer.data(), buffer.size() );
+        buffer.clear();
+      }
+    };
+
+    fmt::format_to( std::back_inserter( buffer ), "{} {}", num_hyperedges(), _num_vertices );
+    if ( use_hyperedge_weights() && use_vertex_weights() )
+    {
+      fmt::format_to( std::back_inserter( buffer ), " 11" );
+    }
+    else if ( use_hyperedge_weights() )
+    {
+      fmt::format_to( std::back_inserter( buffer ), " 1" );
+    }
+    else if ( use_vertex_weights() )
+    {
+      fmt::format_to( std::back_inserter( buffer ), " 10" );
+    }
+    buffer.push_back( '\n' );
+
+    for ( edge_id e = 0; e < num_hyperedges(); ++e )
+    {
+      if ( use_hyperedge_weights() )
+      {
+        // This could be customized, currently use the fanout number as the weight
+        fmt::format_to( std::back_inserter( buffer ), "{} ", _hyperedge_weights[e] );
+      }
+      for ( auto i = _hyperedge_indices[e]; i < _hyperedge_indices[e + 1]; ++i )
+      {
+        fmt::format_to( std::back_inserter( buffer ), "{}", _hyperedges[i] + 1u );
+        buffer.push_back( i + 1u == _hyperedge_indices[e + 1] ? '\n' : ' ' );
+      }
+      flush( false );
+    }
+    // simulate weights of vertices to 1, which could be modified
+    if ( use_vertex_weights() )
+    {
+      for ( auto const& w : _vertex_weights )
+      {
+        fmt::format_to( std::back_inserter( buffer ), "{}\n", w );
+        flush( false );
+      }
+    }
+    fmt::format_to( std::back_inserter( buffer ), "%% Mockturtle finished writing the hMetis file.\n" );
+    if ( _const_vertex )
+    {
+      /* the constant is written like any other vertex, note which one it is */
+      fmt::format_to( std::back_inserter( buffer ), "%% Const exists as the largest index.\n" );
+    }
+    flush( true );
     os.close();
   }
-  int _hypNum;
+
+  void write_csr_sidecar( partition_view_params const& ps ) const
+  {
+    build_hypergraph();
+    write_hypergraph_csr( ps.file_name + ".csr", _num_vertices, _hyperedge_indices, _hyperedges,
+                          use_hyperedge_weights() ? _hyperedge_weights : std::vector<mt_kahypar_hyperedge_weight_t>{},
+                          use_vertex_weights() ? _vertex_weights : std::vector<mt_kahypar_hypernode_weight_t>{} );
+  }
+
   partition_view_params _ps;
-  std::map<node, std::vector<node>> _sinkHyp;
+  mutable bool _hypergraph_built{ false };
+  mutable mt_kahypar_hypernode_id_t _num_vertices{ 0 };
+  mutable bool _const_vertex{ false };
+  mutable std::vector<size_t> _hyperedge_indices;
+  mutable std::vector<mt_kahypar_hyperedge_id_t> _hyperedges;
+  mutable std::vector<mt_kahypar_hyperedge_weight_t> _hyperedge_weights;
+  mutable std::vector<mt_kahypar_hypernode_weight_t> _vertex_weights;
   aig_network _ntk;
-  std::vector<uint32_t> refs;
+  std::vector<block_id> _rejected_blocks;
+  std::vector<std::vector<uint32_t>> _halo_nodes;
+  std::vector<std::vector<node>> _halo_gates;
+  std::vector<std::vector<uint64_t>> _halo_windows; /* structure of the extracted windows with halo, see `window_prefix` */
+  mutable partition_view_stats _st;
 };
 
 } // namespace mockturtle
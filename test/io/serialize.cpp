@@ -122,3 +122,55 @@ TEST_CASE( "read errors are propagated", "[serialize]" )
     CHECK_FALSE( deserialize_network_fallible( input ).has_value() );
   }
 }
+
+TEST_CASE( "read archives of the previous format", "[serialize]" )
+{
+  aig_network aig = create_network();
+  auto const& storage = *aig._storage;
+
+  /* version 1 archives have no header and store the hash table as a `phmap::flat_hash_map` */
+  {
+    detail::serializer _serializer;
+    phmap::BinaryOutputArchive os( file_name );
+    uint64_t size = storage.nodes.size();
+    CHECK( os.dump( (char*)&size, sizeof( uint64_t ) ) );
+    for ( const auto& n : storage.nodes )
+    {
+      CHECK( _serializer( os, n ) );
+    }
+    size = storage.inputs.size();
+    CHECK( os.dump( (char*)&size, sizeof( uint64_t ) ) );
+    for ( const auto& i : storage.inputs )
+    {
+      CHECK( _serializer( os, i ) );
+    }
+    size = storage.outputs.size();
+    CHECK( os.dump( (char*)&size, sizeof( uint64_t ) ) );
+    for ( const auto& o : storage.outputs )
+    {
+      CHECK( _serializer( os, o ) );
+    }
+
+    detail::serializer::legacy_hash_type hash;
+    aig.foreach_gate( [&]( auto const& n ) {
+      hash[storage.nodes[n]] = n;
+    } );
+    CHECK( hash.dump( os ) );
+    CHECK( os.dump( (char*)&storage.trav_id, sizeof( uint32_t ) ) );
+  }
+
+  aig_network aig2 = deserialize_network( file_name );
+  CHECK( aig._storage->nodes == aig2._storage->nodes );
+  CHECK( aig._storage->inputs == aig2._storage->inputs );
+  CHECK( aig._storage->outputs == aig2._storage->outputs );
+  CHECK( aig._storage->hash == aig2._storage->hash );
+
+  /* archives of an unknown version are rejected */
+  {
+    phmap::BinaryOutputArchive os( file_name );
+    uint64_t const header[] = { detail::serializer::magic, detail::serializer::version + 1u };
+    CHECK( os.dump( (char const*)header, sizeof( header ) ) );
+  }
+  phmap::BinaryInputArchive input( file_name );
+  CHECK_FALSE( deserialize_network_fallible( input ).has_value() );
+}
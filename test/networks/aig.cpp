@@ -1,5 +1,8 @@
 #include <catch.hpp>
 
+#include <map>
+#include <random>
+
 #include <kitty/constructors.hpp>
 #include <kitty/dynamic_truth_table.hpp>
 #include <kitty/operations.hpp>
@@ -1081,3 +1084,107 @@ TEST_CASE( "substitute node without re-strashing case 3", "[aig]" )
   CHECK( aig.num_gates() == 2 );
   CHECK( simulate<kitty::static_truth_table<3u>>( aig )[0]._bits == 0x80 );
 }
+
+TEST_CASE( "compact node pointers in AIG storage", "[aig]" )
+{
+  CHECK( sizeof( compact_node_pointer<1> ) == 4u );
+  CHECK( sizeof( compact_regular_node<2, 2, 1> ) == 24u );
+  CHECK( sizeof( regular_node<2, 2, 1> ) == 32u );
+
+  compact_node_pointer<1> p( 0x7fffffffu, 1u );
+  CHECK( p.index == 0x7fffffffu );
+  CHECK( p.weight == 1u );
+  CHECK( p == compact_node_pointer<1>( p.data ) );
+
+  CHECK( storage<compact_regular_node<2, 2, 1>>::max_nodes == UINT64_C( 0x80000000 ) );
+  CHECK( storage<regular_node<2, 2, 1>>::max_nodes == UINT64_C( 0x8000000000000000 ) );
+
+  aig_network aig;
+  auto const a = aig.create_pi();
+  auto const b = aig.create_pi();
+  auto const f = aig.create_and( !a, b );
+  aig.create_po( !f );
+
+  aig_storage::node_type::pointer_type const q = !f;
+  CHECK( aig_network::signal( q ) == !f );
+  CHECK( aig.create_and( b, !a ) == f );
+  CHECK( aig.fanout_size( aig.get_node( a ) ) == 1u );
+  CHECK( simulate<kitty::static_truth_table<2u>>( aig )[0]._bits == 0xb );
+}
+
+TEST_CASE( "structural hash table of an AIG", "[aig]" )
+{
+  using node_type = aig_storage::node_type;
+  auto const make_node = []( uint64_t a, uint64_t b ) {
+    node_type n;
+    n.children[0] = { a >> 1, a & 1 };
+    n.children[1] = { b >> 1, b & 1 };
+    return n;
+  };
+
+  strash_table<node_type> table;
+  std::map<std::pair<uint64_t, uint64_t>, uint64_t> reference;
+  std::mt19937 rng( 42u );
+  for ( auto i = 0u; i < 20000u; ++i )
+  {
+    auto const a = rng() % 256u;
+    auto const b = rng() % 256u;
+    if ( rng() % 3u == 0u )
+    {
+      CHECK( table.erase( make_node( a, b ) ) == reference.erase( { a, b } ) );
+    }
+    else
+    {
+      table[make_node( a, b )] = i;
+      reference[{ a, b }] = i;
+    }
+  }
+
+  CHECK( table.size() == reference.size() );
+  for ( auto a = 0u; a < 256u; ++a )
+  {
+    for ( auto b = 0u; b < 256u; ++b )
+    {
+      auto const it = table.find( make_node( a, b ) );
+      auto const ref = reference.find( { a, b } );
+      REQUIRE( ( it == table.end() ) == ( ref == reference.end() ) );
+      if ( it != table.end() )
+      {
+        CHECK( it->second == ref->second );
+      }
+    }
+  }
+
+  aig_network aig;
+  auto const x = aig.create_pi();
+  auto const y = aig.create_pi();
+  auto const f = aig.create_and( x, !y );
+  aig.take_out_node( aig.get_node( f ) );
+  CHECK( aig.num_gates() == 0u );
+  CHECK( aig.create_and( !y, x ) != f );
+  CHECK( aig.num_gates() == 1u );
+}
+
+namespace
+{
+struct small_strash_table : phmap::flat_hash_map<aig_storage::node_type, uint64_t, aig_hash<aig_storage::node_type>>
+{
+  static constexpr uint64_t max_nodes = 4u;
+};
+} // namespace
+
+TEST_CASE( "node limit of the structural hash table", "[aig]" )
+{
+  /* the literals of 2^31 - 1 nodes still fit into 32 bits without colliding with the empty key */
+  CHECK( strash_table<aig_storage::node_type>::max_nodes == UINT64_C( 0x7fffffff ) );
+  CHECK( aig_storage::max_nodes == strash_table<aig_storage::node_type>::max_nodes );
+  CHECK( storage<aig_storage::node_type>::max_nodes > aig_storage::max_nodes );
+
+  /* the storage refuses nodes beyond the limit of its hash table */
+  storage<aig_storage::node_type, empty_storage_data, aig_hash<aig_storage::node_type>, small_strash_table> s;
+  CHECK( s.max_nodes == 4u );
+  s.nodes.resize( 3u );
+  CHECK_NOTHROW( s.check_capacity() );
+  s.nodes.emplace_back();
+  CHECK_THROWS_AS( s.check_capacity(), std::length_error );
+}
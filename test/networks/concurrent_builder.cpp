@@ -0,0 +1,168 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <unordered_map>
+#include <stdexcept>
+#include <vector>
+
+#include <kitty/dynamic_truth_table.hpp>
+#include <mockturtle/algorithms/cleanup.hpp>
+#include <mockturtle/algorithms/simulation.hpp>
+#include <mockturtle/generators/arithmetic.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/networks/concurrent_builder.hpp>
+#include <mockturtle/networks/xag.hpp>
+#include <mockturtle/utils/parallel_utils.hpp>
+
+using namespace mockturtle;
+
+namespace
+{
+
+template<class Ntk>
+Ntk multiplier( uint32_t bits )
+{
+  Ntk ntk;
+  std::vector<typename Ntk::signal> a( bits ), b( bits );
+  std::generate( a.begin(), a.end(), [&]() { return ntk.create_pi(); } );
+  std::generate( b.begin(), b.end(), [&]() { return ntk.create_pi(); } );
+  for ( auto const& f : carry_ripple_multiplier( ntk, a, b ) )
+  {
+    ntk.create_po( f );
+  }
+  return ntk;
+}
+
+/* copies the cone of every output in its own task, shared gates are merged by the builder */
+template<class Ntk>
+Ntk copy_cones( Ntk const& ntk, concurrent_builder_params const& ps )
+{
+  using signal = typename Ntk::signal;
+
+  concurrent_builder<Ntk> builder( ntk.num_pis(), ps );
+  std::vector<signal> outputs( ntk.num_pos() );
+  parallel_for( ntk.num_pos(), ps.num_threads, [&]( uint32_t i, uint32_t thread_id ) {
+    std::unordered_map<uint64_t, signal> copies;
+    auto const copy = [&]( auto const& self, signal const& f ) -> signal {
+      auto const n = ntk.get_node( f );
+      signal res;
+      if ( ntk.is_constant( n ) )
+      {
+        res = builder.get_constant( false );
+      }
+      else if ( ntk.is_pi( n ) )
+      {
+        res = builder.pi_at( ntk.pi_index( n ) );
+      }
+      else if ( auto const it = copies.find( n ); it != copies.end() )
+      {
+        res = it->second;
+      }
+      else
+      {
+        std::vector<signal> fanins;
+        ntk.foreach_fanin( n, [&]( auto const& fi ) {
+          fanins.push_back( self( self, fi ) );
+        } );
+        res = ntk.is_xor( n ) ? builder.create_xor( fanins[0], fanins[1], thread_id ) : builder.create_and( fanins[0], fanins[1], thread_id );
+        copies[n] = res;
+      }
+      return ntk.is_complemented( f ) ? !res : res;
+    };
+    outputs[i] = copy( copy, ntk.po_at( i ) );
+  } );
+  CHECK( builder.num_gates() >= ntk.num_gates() );
+  return builder.finalize( outputs );
+}
+
+template<class Ntk>
+void check_same_function( Ntk const& a, Ntk const& b )
+{
+  default_simulator<kitty::dynamic_truth_table> sim( a.num_pis() );
+  CHECK( simulate<kitty::dynamic_truth_table>( a, sim ) == simulate<kitty::dynamic_truth_table>( b, sim ) );
+}
+
+} // namespace
+
+TEST_CASE( "build an AIG from several threads", "[concurrent_builder]" )
+{
+  auto const ntk = cleanup_dangling( multiplier<aig_network>( 6u ) );
+
+  concurrent_builder_params ps;
+  ps.num_threads = 4u;
+  ps.chunk_size = 8u;
+  ps.num_stripes = 4u;
+  auto const res = copy_cones( ntk, ps );
+
+  CHECK( res.num_pis() == ntk.num_pis() );
+  CHECK( res.num_pos() == ntk.num_pos() );
+  CHECK( res.num_gates() == ntk.num_gates() );
+  check_same_function( ntk, res );
+
+  /* gates are numbered in topological order */
+  res.foreach_gate( [&]( auto const& n ) {
+    res.foreach_fanin( n, [&]( auto const& fi ) {
+      CHECK( res.get_node( fi ) < n );
+    } );
+  } );
+
+  ps.num_threads = 1u;
+  ps.chunk_size = 4096u;
+  auto const seq = copy_cones( ntk, ps );
+  CHECK( seq.num_gates() == res.num_gates() );
+}
+
+TEST_CASE( "build an XAG from several threads", "[concurrent_builder]" )
+{
+  auto const ntk = cleanup_dangling( multiplier<xag_network>( 5u ) );
+
+  concurrent_builder_params ps;
+  ps.num_threads = 3u;
+  ps.chunk_size = 4u;
+  ps.num_stripes = 2u;
+  auto const res = copy_cones( ntk, ps );
+
+  CHECK( res.num_gates() == ntk.num_gates() );
+  uint32_t num_xors = 0u, res_xors = 0u;
+  ntk.foreach_gate( [&]( auto const& n ) { num_xors += ntk.is_xor( n ) ? 1u : 0u; } );
+  res.foreach_gate( [&]( auto const& n ) { res_xors += res.is_xor( n ) ? 1u : 0u; } );
+  CHECK( num_xors == res_xors );
+  check_same_function( ntk, res );
+}
+
+TEST_CASE( "trivial gates of the concurrent builder", "[concurrent_builder]" )
+{
+  concurrent_builder_params ps;
+  ps.num_threads = 1u;
+  concurrent_builder<aig_network> builder( 2u, ps );
+  auto const a = builder.pi_at( 0u );
+  auto const b = builder.pi_at( 1u );
+
+  CHECK( builder.create_and( a, a, 0u ) == a );
+  CHECK( builder.create_and( a, !a, 0u ) == builder.get_constant( false ) );
+  CHECK( builder.create_and( builder.get_constant( true ), b, 0u ) == b );
+  CHECK( builder.create_and( a, b, 0u ) == builder.create_and( b, a, 0u ) );
+  CHECK( builder.num_gates() == 1u );
+
+  auto const f = builder.create_xor( a, b, 0u );
+  CHECK( builder.num_gates() == 4u );
+
+  auto const res = builder.finalize( { f, builder.get_constant( true ), !a } );
+  CHECK( res.num_gates() == 3u );
+  CHECK( res.num_pos() == 3u );
+  CHECK( simulate<kitty::static_truth_table<2u>>( res )[0]._bits == 0x6 );
+}
+
+TEST_CASE( "node limit of the concurrent builder", "[concurrent_builder]" )
+{
+  /* the PIs fill every slot up to 2^31 - 2, so the first gate takes a chunk beyond the limit */
+  concurrent_builder_params ps;
+  ps.num_threads = 1u;
+  ps.chunk_size = 1u << 16u;
+  concurrent_builder<aig_network> builder( 0x7ffffffeu, ps );
+  auto const a = builder.pi_at( 0u );
+  auto const b = builder.pi_at( 1u );
+
+  CHECK_THROWS_AS( builder.create_and( a, b, 0u ), std::length_error );
+  CHECK( builder.create_and( a, a, 0u ) == a );
+}
@@ -0,0 +1,70 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <mtkahypar.h>
+
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/utils/window_utils.hpp>
+#include <mockturtle/views/color_view.hpp>
+#include <mockturtle/views/partition_view.hpp>
+
+#include "partition_networks.hpp"
+
+using namespace mockturtle;
+
+TEST_CASE( "construct blocks from a dense node-to-block vector", "[partition]" )
+{
+  auto const aig = small_aig();
+  partition_view aig_p{ aig };
+  std::vector<mt_kahypar_partition_id_t> partition{ 0, 0, 1, 1, 0, 1, 1, 0, 1 };
+  auto const node_block = aig_p.node_to_block( partition.data(), partition.size() );
+  CHECK( node_block == std::vector<int>{ -1, 0, 0, 1, 1, 0, 1, 1, 0, 1 } );
+
+  auto const parts = aig_p.construct_from_partition( 2, node_block );
+  CHECK( parts.size() == 2u );
+  CHECK( std::get<0>( parts[0] ).num_gates() == 2u );
+  CHECK( std::get<1>( parts[0] ) == std::vector<aig_network::node>{ 1, 2, 6 } );
+  CHECK( std::get<2>( parts[0] ) == std::vector<aig_network::signal>{ aig.make_signal( 8 ) } );
+  CHECK( std::get<3>( parts[0] ) == std::vector<aig_network::node>{ 5, 8 } );
+  CHECK( std::get<0>( parts[1] ).num_gates() == 3u );
+  CHECK( std::get<1>( parts[1] ) == std::vector<aig_network::node>{ 1, 3, 4, 8 } );
+  CHECK( std::get<2>( parts[1] ) == std::vector<aig_network::signal>{ aig.make_signal( 6 ), aig.make_signal( 9 ) } );
+  CHECK( std::get<3>( parts[1] ) == std::vector<aig_network::node>{ 6, 7, 9 } );
+}
+
+TEST_CASE( "parallel block extraction is deterministic", "[partition]" )
+{
+  auto const aig = multiplier_aig( 8u );
+
+  partition_view_params ps;
+  ps.num_threads = 1u;
+  partition_view aig_p{ aig, ps };
+  auto const node_block = chunk_partition( aig_p, 4 );
+  auto const parts_seq = aig_p.construct_from_partition( 4, node_block );
+
+  ps.num_threads = 4u;
+  partition_view aig_p_par{ aig, ps };
+  auto const parts_par = aig_p_par.construct_from_partition( 4, node_block );
+
+  REQUIRE( parts_seq.size() == parts_par.size() );
+  uint32_t num_gates = 0u;
+  for ( auto i = 0u; i < parts_seq.size(); ++i )
+  {
+    CHECK( std::get<0>( parts_seq[i] ).num_gates() == std::get<0>( parts_par[i] ).num_gates() );
+    CHECK( std::get<1>( parts_seq[i] ) == std::get<1>( parts_par[i] ) );
+    CHECK( std::get<2>( parts_seq[i] ) == std::get<2>( parts_par[i] ) );
+    CHECK( std::get<3>( parts_seq[i] ) == std::get<3>( parts_par[i] ) );
+    num_gates += std::get<3>( parts_par[i] ).size();
+
+    /* same boundaries as with the window utilities */
+    color_view c_aig{ aig };
+    auto inputs = collect_inputs( c_aig, std::get<3>( parts_par[i] ) );
+    std::sort( inputs.begin(), inputs.end() );
+    std::vector<uint32_t> refs( aig.size(), 0u );
+    CHECK( std::get<1>( parts_par[i] ) == inputs );
+    CHECK( std::get<2>( parts_par[i] ) == collect_outputs( c_aig, inputs, std::get<3>( parts_par[i] ), refs ) );
+  }
+  CHECK( num_gates == aig.num_gates() );
+}
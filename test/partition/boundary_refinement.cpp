@@ -0,0 +1,95 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <kitty/dynamic_truth_table.hpp>
+#include <mockturtle/algorithms/aig_resub.hpp>
+#include <mockturtle/algorithms/boundary_refinement.hpp>
+#include <mockturtle/algorithms/cleanup.hpp>
+#include <mockturtle/algorithms/partition_optimization.hpp>
+#include <mockturtle/algorithms/simulation.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/views/partition_view.hpp>
+
+#include "partition_networks.hpp"
+
+using namespace mockturtle;
+
+namespace
+{
+
+/* block inputs plus outputs as extracted by the view */
+int64_t boundary( partition_view& aig_p, int num_blocks, std::vector<int> const& node_block )
+{
+  aig_p.block_views( num_blocks, node_block );
+  int64_t result = 0;
+  for ( auto const& b : aig_p.stats().blocks )
+  {
+    result += b.num_pis + b.num_pos;
+  }
+  return result;
+}
+
+} // namespace
+
+TEST_CASE( "refine a partition towards fewer block inputs and outputs", "[partition]" )
+{
+  auto const aig = multiplier_aig( 6u );
+
+  partition_view_params ps;
+  ps.num_blocks = 4;
+  partition_view aig_p{ aig, ps };
+  auto const node_block = modulo_partition( aig, ps.num_blocks );
+
+  boundary_refinement_stats st;
+  auto const refined = boundary_refinement( aig_p, node_block, {}, &st );
+  REQUIRE( refined.size() == node_block.size() );
+  CHECK( st.initial_boundary == boundary( aig_p, ps.num_blocks, node_block ) );
+  CHECK( st.boundary == boundary( aig_p, ps.num_blocks, refined ) );
+  CHECK( st.boundary < st.initial_boundary );
+  CHECK( st.num_moves > 0u );
+
+  /* only gates move, and the blocks stay balanced */
+  std::vector<uint32_t> block_size( ps.num_blocks, 0u );
+  aig.foreach_node( [&]( auto const& n ) {
+    if ( !aig.is_and( n ) )
+    {
+      CHECK( refined[n] == node_block[n] );
+      return;
+    }
+    REQUIRE( refined[n] >= 0 );
+    REQUIRE( refined[n] < ps.num_blocks );
+    block_size[refined[n]]++;
+  } );
+  auto const max_size = ( 1.0 + ps.epsilon ) * ( ( aig.num_gates() + ps.num_blocks - 1 ) / ps.num_blocks );
+  CHECK( *std::max_element( block_size.begin(), block_size.end() ) <= max_size );
+
+  /* refining again does not increase the boundary */
+  boundary_refinement_stats st2;
+  boundary_refinement( aig_p, refined, {}, &st2 );
+  CHECK( st2.initial_boundary == st.boundary );
+  CHECK( st2.boundary <= st.boundary );
+}
+
+TEST_CASE( "optimize the blocks of a refined partition", "[partition]" )
+{
+  auto const aig = multiplier_aig( 6u );
+
+  partition_view_params ps;
+  ps.num_blocks = 4;
+  partition_view aig_p{ aig, ps };
+
+  partition_optimization_params opt_ps;
+  opt_ps.refine_boundaries = true;
+  partition_optimization_stats opt_st;
+  partition_optimizer opt( opt_ps, opt_st );
+  opt.add_script( []( aig_network& ntk ) {
+    aig_resubstitution( ntk );
+    ntk = cleanup_dangling( ntk );
+  } );
+  auto const res = opt.run( aig_p, modulo_partition( aig, ps.num_blocks ) );
+
+  CHECK( opt_st.boundary_reduction > 0 );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+}
@@ -1,4 +1,9 @@
 #include <catch.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
 #include <fmt/core.h>
 #include <mtkahypar.h>
 
@@ -6,25 +11,15 @@
 #include <mockturtle/traits.hpp>
 #include <mockturtle/views/partition_view.hpp>
 
+#include "partition_networks.hpp"
+
 using namespace mockturtle;
 
 TEST_CASE( "create and dump hypergraph from an AIG", "[partition]" )
 {
-  aig_network aig;
-  const auto x1 = aig.create_pi();
-  const auto x2 = aig.create_pi();
-  const auto x3 = aig.create_pi();
-  const auto x4 = aig.create_pi();
-
-  const auto f1 = aig.create_and( x1, x2 );
-  const auto f2 = aig.create_and( x3, x4 );
-  const auto f3 = aig.create_and( x1, x3 );
-  const auto f4 = aig.create_and( f1, f2 );
-  const auto f5 = aig.create_and( f3, f4 );
-
-  aig.create_po( f5 );
-
+  auto const aig = small_aig();
   partition_view_params ps;
+  ps.write_hmetis = true;
   ps.file_name = fmt::format( "{}/test.hmetis", PARTITION_TEST_PATH );
   partition_view aig_p{ aig, ps };
 
@@ -42,3 +37,49 @@ TEST_CASE( "create and dump hypergraph from an AIG", "[partition]" )
   ps.file_name = fmt::format( "{}/test_edge_vertices_weight.hmetis", PARTITION_TEST_PATH );
   partition_view aig_p_e_v_w{ aig, ps };
 }
+
+TEST_CASE( "dump the hypergraph of an AIG reading the constant", "[partition]" )
+{
+  aig_network aig;
+  const auto x1 = aig.create_pi();
+  const auto x2 = aig.create_pi();
+  const auto f = aig.create_and( x1, x2 );
+  aig.create_po( f );
+
+  /* strashing never creates gates reading the constant, but a network may still contain them */
+  aig._storage->nodes[aig.get_node( f )].children[0] = aig.get_constant( true );
+
+  partition_view_params ps;
+  ps.write_hmetis = true;
+  ps.file_name = fmt::format( "{}/test_const.hmetis", PARTITION_TEST_PATH );
+  partition_view aig_p{ aig, ps };
+  CHECK( aig_p.num_vertices() == 4u );
+
+  /* the constant is the last vertex */
+  std::ifstream is( ps.file_name );
+  std::stringstream ss;
+  ss << is.rdbuf();
+  CHECK( ss.str() == "2 4\n2 3\n4 3\n%% Mockturtle finished writing the hMetis file.\n%% Const exists as the largest index.\n" );
+}
+
+TEST_CASE( "build hypergraph of an AIG in memory", "[partition]" )
+{
+  auto const aig = small_aig();
+  partition_view aig_p{ aig };
+  CHECK( aig_p.num_vertices() == 9u );
+  CHECK( aig_p.num_hyperedges() == 8u );
+  CHECK( aig_p.hyperedge_indices() == std::vector<size_t>{ 0, 3, 5, 8, 10, 12, 14, 16, 18 } );
+  CHECK( aig_p.hyperedges() == std::vector<mt_kahypar_hyperedge_id_t>{ 0, 4, 6, 1, 4, 2, 5, 6, 3, 5, 4, 7, 5, 7, 6, 8, 7, 8 } );
+}
+
+TEST_CASE( "timing-driven hypergraph weights", "[partition]" )
+{
+  auto const aig = small_aig();
+  partition_view_params ps;
+  ps.timing_weights = true;
+  partition_view aig_p{ aig, ps };
+
+  /* f3 has a slack of 1, all other nodes are on a critical path */
+  CHECK( aig_p.hyperedge_weights() == std::vector<mt_kahypar_hyperedge_weight_t>{ 16, 16, 16, 16, 16, 16, 7, 16 } );
+  CHECK( aig_p.vertex_weights() == std::vector<mt_kahypar_hypernode_weight_t>{ 2, 2, 2, 2, 2, 2, 1, 2, 2 } );
+}
@@ -0,0 +1,89 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <fmt/core.h>
+#include <lorina/aiger.hpp>
+
+#include <mockturtle/io/aiger_hypergraph_reader.hpp>
+#include <mockturtle/io/hypergraph_csr.hpp>
+#include <mockturtle/io/write_aiger.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/views/partition_view.hpp>
+
+#include "partition_networks.hpp"
+
+using namespace mockturtle;
+
+TEST_CASE( "write hMetis file and binary CSR sidecar", "[partition]" )
+{
+  auto const aig = small_aig();
+  partition_view_params ps;
+  ps.write_hmetis = true;
+  ps.write_csr = true;
+  ps.si_w_on_hyperedges = true;
+  ps.file_name = fmt::format( "{}/test_sidecar.hmetis", PARTITION_TEST_PATH );
+  partition_view aig_p{ aig, ps };
+
+  std::ifstream is( ps.file_name );
+  std::stringstream hmetis;
+  hmetis << is.rdbuf();
+  CHECK( hmetis.str() == "8 9 1\n2 1 5 7\n1 2 5\n2 3 6 7\n1 4 6\n1 5 8\n1 6 8\n1 7 9\n1 8 9\n"
+                         "%% Mockturtle finished writing the hMetis file.\n" );
+
+  auto const csr = read_hypergraph_csr( ps.file_name + ".csr" );
+  REQUIRE( csr );
+  CHECK( csr->num_vertices == aig_p.num_vertices() );
+  CHECK( csr->num_hyperedges() == aig_p.num_hyperedges() );
+  CHECK( std::equal( csr->indices.begin(), csr->indices.end(), aig_p.hyperedge_indices().begin(), aig_p.hyperedge_indices().end() ) );
+  CHECK( std::equal( csr->pins.begin(), csr->pins.end(), aig_p.hyperedges().begin(), aig_p.hyperedges().end() ) );
+  CHECK( std::equal( csr->hyperedge_weights.begin(), csr->hyperedge_weights.end(), aig_p.hyperedge_weights().begin(), aig_p.hyperedge_weights().end() ) );
+  CHECK( csr->vertex_weights.empty() );
+}
+
+TEST_CASE( "stream the hypergraph of an AIGER file", "[partition]" )
+{
+  auto const aig = multiplier_aig( 6u );
+  std::stringstream file;
+  write_aiger( aig, file );
+
+  /* the hypergraph is complete while the reader is still alive */
+  hypergraph_csr hg;
+  aiger_hypergraph_reader reader( hg );
+  REQUIRE( lorina::read_aiger( file, reader ) == lorina::return_code::success );
+
+  partition_view_params ps;
+  ps.si_w_on_hyperedges = true;
+  partition_view aig_p{ aig, ps };
+  CHECK( hg.num_vertices == aig_p.num_vertices() );
+  CHECK( hg.num_hyperedges() == aig_p.num_hyperedges() );
+  CHECK( std::equal( hg.indices.begin(), hg.indices.end(), aig_p.hyperedge_indices().begin(), aig_p.hyperedge_indices().end() ) );
+  CHECK( std::equal( hg.pins.begin(), hg.pins.end(), aig_p.hyperedges().begin(), aig_p.hyperedges().end() ) );
+  CHECK( std::equal( hg.hyperedge_weights.begin(), hg.hyperedge_weights.end(), aig_p.hyperedge_weights().begin(), aig_p.hyperedge_weights().end() ) );
+  CHECK( hg.vertex_weights.empty() );
+}
+
+TEST_CASE( "stream the hypergraph of an AIGER file without AND gates", "[partition]" )
+{
+  std::stringstream file( "aag 2 2 0 1 0\n2\n4\n4\n" );
+  hypergraph_csr hg;
+  aiger_hypergraph_reader reader( hg );
+  REQUIRE( lorina::read_ascii_aiger( file, reader ) == lorina::return_code::success );
+  CHECK( hg.num_vertices == 2u );
+  CHECK( hg.num_hyperedges() == 0u );
+  CHECK( hg.pins.empty() );
+}
+
+TEST_CASE( "keep the hypergraph untouched on an AIGER parse error", "[partition]" )
+{
+  /* the second AND gate is malformed */
+  std::stringstream file( "aag 4 2 0 1 2\n2\n4\n8\n6 2 4\n8 6\n" );
+  hypergraph_csr hg;
+  aiger_hypergraph_reader reader( hg );
+  CHECK( lorina::read_ascii_aiger( file, reader ) == lorina::return_code::parse_error );
+  CHECK( hg.num_vertices == 0u );
+  CHECK( hg.num_hyperedges() == 0u );
+  CHECK( hg.pins.empty() );
+}
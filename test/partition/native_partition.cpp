@@ -0,0 +1,70 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include <kitty/dynamic_truth_table.hpp>
+#include <mockturtle/algorithms/native_partition.hpp>
+#include <mockturtle/algorithms/simulation.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/views/partition_view.hpp>
+
+#include "partition_networks.hpp"
+
+using namespace mockturtle;
+
+namespace
+{
+
+/* connectivity of a node-to-block vector */
+int64_t km1( partition_view const& aig_p, std::vector<partition_view::block_id> const& node_block )
+{
+  auto const& indices = aig_p.hyperedge_indices();
+  auto const& pins = aig_p.hyperedges();
+  int64_t result = 0;
+  for ( auto e = 0u; e < aig_p.num_hyperedges(); ++e )
+  {
+    std::set<int> blocks;
+    for ( auto i = indices[e]; i < indices[e + 1]; ++i )
+    {
+      blocks.insert( node_block[pins[i] + 1u] );
+    }
+    result += blocks.size() - 1u;
+  }
+  return result;
+}
+
+} // namespace
+
+TEST_CASE( "partition without mt-KaHyPar", "[partition]" )
+{
+  auto const aig = multiplier_aig( 6u );
+
+  partition_view_params ps;
+  ps.num_blocks = 4;
+  partition_view aig_p{ aig, ps };
+
+  native_partition_stats st;
+  auto const node_block = native_partition( aig_p, {}, &st );
+  REQUIRE( node_block.size() == aig.size() );
+  CHECK( node_block[0] == -1 );
+
+  /* balanced, and the refinement does not make the cut worse */
+  std::vector<uint32_t> block_size( ps.num_blocks, 0u );
+  for ( auto i = 1u; i < node_block.size(); ++i )
+  {
+    REQUIRE( node_block[i] >= 0 );
+    REQUIRE( node_block[i] < ps.num_blocks );
+    block_size[node_block[i]]++;
+  }
+  auto const max_size = ( 1.0 + ps.epsilon ) * ( ( aig_p.num_vertices() + ps.num_blocks - 1 ) / ps.num_blocks );
+  CHECK( *std::max_element( block_size.begin(), block_size.end() ) <= max_size );
+  CHECK( st.km1 == km1( aig_p, node_block ) );
+  CHECK( st.km1 <= st.initial_km1 );
+
+  /* the rest of the flow works unchanged */
+  auto parts = aig_p.construct_from_partition( ps.num_blocks, node_block );
+  auto const res = aig_p.reunite( parts );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+}
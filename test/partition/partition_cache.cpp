@@ -0,0 +1,75 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/utils/partition_cache.hpp>
+#include <mockturtle/views/partition_view.hpp>
+
+#include "partition_networks.hpp"
+
+using namespace mockturtle;
+
+TEST_CASE( "store and load partitions in the cache", "[partition]" )
+{
+  auto const aig = adder_aig( 16u );
+  partition_cache cache( PARTITION_TEST_PATH );
+
+  partition_view_params ps;
+  ps.num_blocks = 3;
+  ps.seed = 4711;
+  std::remove( cache.file_name( aig, ps, "native" ).c_str() );
+  CHECK( !cache.load( aig, ps, "native" ) );
+
+  auto const node_block = modulo_partition( aig, 3 );
+  REQUIRE( cache.store( aig, ps, "native", node_block ) );
+  auto const loaded = cache.load( aig, ps, "native" );
+  REQUIRE( loaded );
+  CHECK( *loaded == node_block );
+
+  /* other parameters or another network miss the cache */
+  auto other_ps = ps;
+  other_ps.epsilon = 0.05;
+  CHECK( cache.file_name( aig, other_ps, "native" ) != cache.file_name( aig, ps, "native" ) );
+  CHECK( !cache.load( aig, other_ps, "native" ) );
+  CHECK( cache.file_name( aig, ps, "mt-kahypar:deterministic:km1" ) != cache.file_name( aig, ps, "native" ) );
+  CHECK( cache.file_name( aig, ps, "mt-kahypar:deterministic:km1" ) != cache.file_name( aig, ps, "mt-kahypar:deterministic:soed" ) );
+  CHECK( !cache.load( aig, ps, "mt-kahypar:deterministic:km1" ) );
+  CHECK( partition_cache::structural_hash( adder_aig( 15u ) ) != partition_cache::structural_hash( aig ) );
+  CHECK( partition_cache::structural_hash( adder_aig( 16u ) ) == partition_cache::structural_hash( aig ) );
+
+  /* more than 256 blocks need wider entries */
+  ps.num_blocks = 300;
+  auto const many_blocks = modulo_partition( aig, 300 );
+  REQUIRE( cache.store( aig, ps, "native", many_blocks ) );
+  CHECK( *cache.load( aig, ps, "native" ) == many_blocks );
+
+  std::remove( cache.file_name( aig, ps, "native" ).c_str() );
+}
+
+TEST_CASE( "compute partitions only on cache misses", "[partition]" )
+{
+  auto const aig = adder_aig( 8u );
+  partition_cache cache( PARTITION_TEST_PATH );
+  partition_view_params ps;
+  ps.seed = 815;
+  std::remove( cache.file_name( aig, ps, "native" ).c_str() );
+
+  uint32_t num_calls = 0u;
+  auto compute = [&]() {
+    ++num_calls;
+    return modulo_partition( aig, 2 );
+  };
+  CHECK( cache.get_or_compute( aig, ps, "native", compute ) == modulo_partition( aig, 2 ) );
+  CHECK( cache.get_or_compute( aig, ps, "native", compute ) == modulo_partition( aig, 2 ) );
+  CHECK( num_calls == 1u );
+
+  /* the cached partition can be used without building the hypergraph */
+  partition_view aig_p{ aig, ps };
+  auto const parts = aig_p.construct_from_partition( 2, *cache.load( aig, ps, "native" ) );
+  CHECK( parts.size() == 2u );
+
+  std::remove( cache.file_name( aig, ps, "native" ).c_str() );
+}
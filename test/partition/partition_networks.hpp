@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <mtkahypar.h>
+
+#include <mockturtle/generators/arithmetic.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/views/partition_view.hpp>
+
+namespace mockturtle
+{
+
+/* f5 = ( x1 & x3 ) & ( ( x1 & x2 ) & ( x3 & x4 ) ) with the gates f1, ..., f5 as nodes 5, ..., 9 */
+inline aig_network small_aig()
+{
+  aig_network aig;
+  const auto x1 = aig.create_pi();
+  const auto x2 = aig.create_pi();
+  const auto x3 = aig.create_pi();
+  const auto x4 = aig.create_pi();
+
+  const auto f1 = aig.create_and( x1, x2 );
+  const auto f2 = aig.create_and( x3, x4 );
+  const auto f3 = aig.create_and( x1, x3 );
+  const auto f4 = aig.create_and( f1, f2 );
+  const auto f5 = aig.create_and( f3, f4 );
+
+  aig.create_po( f5 );
+  return aig;
+}
+
+inline aig_network adder_aig( uint32_t width )
+{
+  aig_network aig;
+  std::vector<aig_network::signal> a( width ), b( width );
+  std::generate( a.begin(), a.end(), [&]() { return aig.create_pi(); } );
+  std::generate( b.begin(), b.end(), [&]() { return aig.create_pi(); } );
+  auto carry = aig.get_constant( false );
+  carry_ripple_adder_inplace( aig, a, b, carry );
+  std::for_each( a.begin(), a.end(), [&]( auto const& f ) { aig.create_po( f ); } );
+  aig.create_po( carry );
+  return aig;
+}
+
+inline aig_network multiplier_aig( uint32_t width )
+{
+  aig_network aig;
+  std::vector<aig_network::signal> a( width ), b( width );
+  std::generate( a.begin(), a.end(), [&]() { return aig.create_pi(); } );
+  std::generate( b.begin(), b.end(), [&]() { return aig.create_pi(); } );
+  for ( auto const& f : carry_ripple_multiplier( aig, a, b ) )
+  {
+    aig.create_po( f );
+  }
+  return aig;
+}
+
+/* every PO is x_i & ( x_i & x_{i+1} ), which takes one redundant gate */
+inline aig_network redundant_aig( uint32_t num_pos )
+{
+  aig_network aig;
+  std::vector<aig_network::signal> x( num_pos + 1u );
+  for ( auto& f : x )
+  {
+    f = aig.create_pi();
+  }
+  for ( auto i = 0u; i < num_pos; ++i )
+  {
+    aig.create_po( aig.create_and( x[i], aig.create_and( x[i], x[i + 1] ) ) );
+  }
+  return aig;
+}
+
+/* contiguous chunks of gates, PIs do not belong to any block's logic */
+inline std::vector<int> chunk_partition( aig_network const& aig, int num_blocks )
+{
+  std::vector<int> node_block( aig.size(), 0 );
+  node_block[0] = -1;
+  auto i = 0u;
+  aig.foreach_gate( [&]( auto const& n ) {
+    node_block[n] = i++ * num_blocks / aig.num_gates();
+  } );
+  return node_block;
+}
+
+/* contiguous chunks of hypernodes */
+inline std::vector<int> chunk_partition( partition_view const& aig_p, int num_blocks )
+{
+  std::vector<mt_kahypar_partition_id_t> partition( aig_p.num_vertices() );
+  for ( auto i = 0u; i < partition.size(); ++i )
+  {
+    partition[i] = i * num_blocks / partition.size();
+  }
+  return aig_p.node_to_block( partition.data(), partition.size() );
+}
+
+/* scattered blocks with a large boundary */
+inline std::vector<int> modulo_partition( aig_network const& aig, int num_blocks )
+{
+  std::vector<int> node_block( aig.size() );
+  node_block[0] = -1;
+  for ( auto i = 1u; i < aig.size(); ++i )
+  {
+    node_block[i] = i % num_blocks;
+  }
+  return node_block;
+}
+
+} // namespace mockturtle
@@ -0,0 +1,322 @@
+#include <catch.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <kitty/dynamic_truth_table.hpp>
+#include <mtkahypar.h>
+#include <mockturtle/algorithms/aig_resub.hpp>
+#include <mockturtle/algorithms/cleanup.hpp>
+#include <mockturtle/algorithms/partition_equivalence_checking.hpp>
+#include <mockturtle/algorithms/partition_optimization.hpp>
+#include <mockturtle/algorithms/simulation.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/views/partition_view.hpp>
+
+#include "partition_networks.hpp"
+
+using namespace mockturtle;
+
+TEST_CASE( "optimize all blocks concurrently and reunite them", "[partition]" )
+{
+  auto aig = redundant_aig( 16u );
+  CHECK( aig.num_gates() == 32u );
+
+  partition_view aig_p{ aig };
+  auto const node_block = chunk_partition( aig, 4 );
+
+  partition_optimization_params ps;
+  ps.num_threads = 4u;
+  partition_optimization_stats st;
+  auto res = partition_optimization(
+      aig_p, node_block, []( aig_network& ntk ) {
+        aig_resubstitution( ntk );
+        ntk = cleanup_dangling( ntk );
+      },
+      ps, &st );
+
+  CHECK( st.num_blocks == 4u );
+  CHECK( st.num_improved == 4u );
+  CHECK( st.num_rejected == 0u );
+  CHECK( res.num_gates() == 16u );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+}
+
+TEST_CASE( "keep the original block logic unless the cost improves", "[partition]" )
+{
+  auto aig = redundant_aig( 16u );
+  partition_view aig_p{ aig };
+  auto const node_block = chunk_partition( aig, 4 );
+
+  partition_optimization_stats st;
+  partition_optimizer opt( {}, st );
+  /* f = f & ( f | x_0 ) adds two gates to every output */
+  opt.add_script( []( aig_network& ntk ) {
+    std::vector<aig_network::signal> pos;
+    ntk.foreach_po( [&]( auto const& f ) {
+      pos.push_back( f );
+    } );
+    for ( auto const& f : pos )
+    {
+      ntk.replace_in_outputs( ntk.get_node( f ), ntk.create_and( f, ntk.create_or( f, ntk.make_signal( ntk.pi_at( 0 ) ) ) ) ^ ntk.is_complemented( f ) );
+    }
+  } );
+  auto res = opt.run( aig_p, node_block );
+
+  CHECK( st.num_improved == 0u );
+  CHECK( res.num_gates() == aig.num_gates() );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+}
+
+TEST_CASE( "optimize the levels of a partition tree", "[partition]" )
+{
+  mt_kahypar_initialize( std::thread::hardware_concurrency(), true );
+
+  auto aig = redundant_aig( 16u );
+  partition_view_params view_ps;
+  view_ps.max_block_size = 8u;
+  view_ps.write_hmetis = true;
+  view_ps.file_name = std::string( PARTITION_TEST_PATH ) + "/tree.hmetis";
+  partition_view aig_p{ aig, view_ps };
+  auto const read_file = [&]() {
+    std::ifstream is( view_ps.file_name );
+    return std::string( std::istreambuf_iterator<char>( is ), std::istreambuf_iterator<char>() );
+  };
+  auto const hmetis = read_file();
+
+  mt_kahypar_error_t error{};
+  auto const tree = aig_p.partition_recursively( &error );
+  REQUIRE( tree );
+  REQUIRE( tree->nodes[0].height >= 2u );
+
+  partition_optimization_params ps;
+  ps.hierarchy_levels = 2u;
+  partition_optimization_stats st;
+  partition_optimizer opt( ps, st );
+  opt.add_script( []( aig_network& ntk ) {
+    aig_resubstitution( ntk );
+    ntk = cleanup_dangling( ntk );
+  } );
+  auto res = opt.run( aig_p, *tree );
+
+  uint32_t num_level_1, num_level_2;
+  tree->merge_leaves( 1u, num_level_1 );
+  tree->merge_leaves( 2u, num_level_2 );
+  CHECK( st.num_blocks <= tree->num_blocks + num_level_1 + num_level_2 );
+  CHECK( res.num_gates() == 16u );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+
+  /* the views of the levels do not write the hypergraph again */
+  CHECK( read_file() == hmetis );
+}
+
+TEST_CASE( "repartition from the blocks of the previous round", "[partition]" )
+{
+  mt_kahypar_initialize( std::thread::hardware_concurrency(), true );
+
+  auto aig = redundant_aig( 16u );
+  partition_view aig_p{ aig };
+  auto const node_block = chunk_partition( aig, 4 );
+
+  partition_optimization_stats st;
+  partition_optimizer opt( {}, st );
+  opt.add_script( []( aig_network& ntk ) {
+    aig_resubstitution( ntk );
+    ntk = cleanup_dangling( ntk );
+  } );
+  std::vector<partition_view::block_id> node_origin;
+  auto res = opt.run( aig_p, node_block, &node_origin );
+  REQUIRE( node_origin.size() == res.size() );
+
+  partition_view_params ps;
+  ps.num_blocks = 4;
+  partition_view res_p{ res, ps };
+
+  /* every gate starts in the block it was created from, PIs follow their readers */
+  auto const initial = res_p.initial_partition( node_origin );
+  REQUIRE( initial.size() == res_p.num_vertices() );
+  res.foreach_gate( [&]( auto const& n ) {
+    CHECK( initial[n - 1] == node_origin[n] );
+  } );
+  res.foreach_pi( [&]( auto const& n ) {
+    CHECK( initial[n - 1] >= 0 );
+    CHECK( initial[n - 1] < 4 );
+  } );
+
+  mt_kahypar_context_t* context = mt_kahypar_context_from_preset( DETERMINISTIC );
+  mt_kahypar_set_partitioning_parameters( context, ps.num_blocks, ps.epsilon, KM1 );
+  mt_kahypar_error_t error{};
+  auto const refined = res_p.improve_partition( node_origin, context, &error );
+  mt_kahypar_free_context( context );
+  REQUIRE( refined );
+  REQUIRE( refined->size() == res.size() );
+
+  auto res2 = opt.run( res_p, *refined );
+  CHECK( simulate<kitty::dynamic_truth_table>( res2, { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+}
+
+TEST_CASE( "verify optimized blocks with per-block miters", "[partition]" )
+{
+  auto aig = redundant_aig( 16u );
+  partition_view aig_p{ aig };
+  auto const node_block = chunk_partition( aig, 4 );
+
+  /* a wrong "optimization": every output becomes the AND of the first two inputs */
+  auto const wrong_script = []( aig_network& ntk ) {
+    auto const f = ntk.create_and( ntk.make_signal( ntk.pi_at( 0 ) ), ntk.make_signal( ntk.pi_at( 1 ) ) );
+    std::vector<aig_network::node> pos;
+    ntk.foreach_po( [&]( auto const& g ) {
+      pos.push_back( ntk.get_node( g ) );
+    } );
+    for ( auto const& n : pos )
+    {
+      ntk.replace_in_outputs( n, f );
+    }
+    ntk = cleanup_dangling( ntk );
+  };
+
+  partition_optimization_params ps;
+  ps.num_threads = 4u;
+  ps.verify = true;
+  partition_optimization_stats st;
+  auto res = partition_optimization( aig_p, node_block, wrong_script, ps, &st );
+  CHECK( st.num_improved == 0u );
+  CHECK( st.num_unverified == 4u );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+
+  partition_optimization_stats st_resub;
+  res = partition_optimization(
+      aig_p, node_block, []( aig_network& ntk ) {
+        aig_resubstitution( ntk );
+        ntk = cleanup_dangling( ntk );
+      },
+      ps, &st_resub );
+  CHECK( st_resub.num_improved == 4u );
+  CHECK( st_resub.num_unverified == 0u );
+  CHECK( res.num_gates() == 16u );
+
+  /* stand-alone check of the touched blocks only */
+  auto const original = aig_p.construct_from_partition( 4, node_block );
+  auto optimized = aig_p.construct_from_partition( 4, node_block );
+  wrong_script( std::get<0>( optimized[1] ) );
+  aig_resubstitution( std::get<0>( optimized[2] ) );
+  auto const results = partition_equivalence_checking( original, optimized, { 1u, 2u }, 2u );
+  REQUIRE( results.size() == 2u );
+  CHECK( results[0] == std::optional<bool>( false ) );
+  CHECK( results[1] == std::optional<bool>( true ) );
+}
+
+TEST_CASE( "optimize blocks in worker processes", "[partition]" )
+{
+  if ( !has_process_workers() )
+  {
+    return;
+  }
+
+  /* blocks of 2, 4, 6 and 8 gates */
+  auto aig = redundant_aig( 10u );
+  std::vector<int> node_block( aig.size(), 0 );
+  node_block[0] = -1;
+  auto i = 0u;
+  aig.foreach_gate( [&]( auto const& n ) {
+    node_block[n] = i < 2u ? 0 : ( i < 6u ? 1 : ( i < 12u ? 2 : 3 ) );
+    ++i;
+  } );
+  partition_view aig_p{ aig };
+
+  /* the script crashes on the smallest block and hangs on the second one */
+  auto const script = []( aig_network& ntk ) {
+    if ( ntk.num_gates() == 2u )
+    {
+      std::abort();
+    }
+    while ( ntk.num_gates() == 4u )
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    aig_resubstitution( ntk );
+    ntk = cleanup_dangling( ntk );
+  };
+
+  partition_optimization_params ps;
+  ps.num_threads = 4u;
+  ps.use_processes = true;
+  ps.block_timeout = 1.0;
+  ps.verify = true;
+  partition_optimization_stats st;
+  auto const res = partition_optimization( aig_p, node_block, script, ps, &st );
+  CHECK( st.num_failed == 1u );
+  CHECK( st.num_timeouts == 1u );
+  CHECK( st.num_improved == 2u );
+  CHECK( res.num_gates() == 2u + 4u + 3u + 4u );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+}
+
+TEST_CASE( "optimize blocks with halos across their boundaries", "[partition]" )
+{
+  /* the inner gates x_i & x_{i+1} in block 0, the redundant outer ones in block 1 */
+  auto aig = redundant_aig( 8u );
+  std::vector<int> node_block( aig.size(), 0 );
+  node_block[0] = -1;
+  aig.foreach_po( [&]( auto const& f ) {
+    node_block[aig.get_node( f )] = 1;
+  } );
+  auto const script = []( aig_network& ntk ) {
+    aig_resubstitution( ntk );
+    ntk = cleanup_dangling( ntk );
+  };
+
+  /* disjoint blocks cannot see that x_i & ( x_i & x_{i+1} ) = x_i & x_{i+1} */
+  partition_view disjoint{ aig };
+  auto res = partition_optimization( disjoint, node_block, script );
+  CHECK( res.num_gates() == 16u );
+
+  partition_view_params ps;
+  ps.halo_levels = 1u;
+  partition_view aig_p{ aig, ps };
+  auto const parts = aig_p.construct_from_partition( 2, node_block );
+  CHECK( aig_p.stats().blocks[0].num_halo_gates == 8u );
+  CHECK( aig_p.stats().blocks[1].num_halo_gates == 8u );
+  for ( auto b = 0u; b < 2u; ++b )
+  {
+    /* ownership stays exclusive, halo gates of block 0 are exposed as extra POs */
+    CHECK( std::get<3>( parts[b] ).size() == 8u );
+    CHECK( std::get<0>( parts[b] ).num_gates() == 16u );
+    CHECK( std::get<0>( parts[b] ).num_pis() == std::get<1>( parts[b] ).size() );
+    CHECK( std::get<0>( parts[b] ).num_pos() == ( b == 0u ? 16u : 8u ) );
+    /* all halo gates are outputs of the other block, the reunion takes them from there */
+    CHECK( aig_p.halo_nodes( b ).size() == 8u );
+  }
+  CHECK( simulate<kitty::dynamic_truth_table>( aig_p.reunite( parts ), { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+
+  /* windows whose nodes moved fall back to their own copy of the halo */
+  auto moved = parts;
+  for ( auto& part : moved )
+  {
+    script( std::get<0>( part ) );
+  }
+  CHECK( simulate<kitty::dynamic_truth_table>( aig_p.reunite( moved ), { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+
+  /* so do windows which keep their size but not their fanins */
+  auto rewired = parts;
+  for ( auto& part : rewired )
+  {
+    auto& ntk = std::get<0>( part );
+    ntk = ntk.clone();
+    auto& children = ntk._storage->nodes[ntk.num_pis() + 1u].children;
+    std::swap( children[0], children[1] );
+  }
+  CHECK( simulate<kitty::dynamic_truth_table>( aig_p.reunite( rewired ), { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+
+  partition_optimization_params opt_ps;
+  opt_ps.verify = true;
+  partition_optimization_stats st;
+  res = partition_optimization( aig_p, node_block, script, opt_ps, &st );
+  CHECK( st.num_rejected == 0u );
+  CHECK( res.num_gates() == 8u );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, { aig.num_pis() } ) == simulate<kitty::dynamic_truth_table>( aig, { aig.num_pis() } ) );
+}
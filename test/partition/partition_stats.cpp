@@ -0,0 +1,70 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/utils/stopwatch.hpp>
+#include <mockturtle/views/partition_view.hpp>
+
+#include "partition_networks.hpp"
+
+using namespace mockturtle;
+
+TEST_CASE( "partition statistics", "[partition]" )
+{
+  auto const aig = adder_aig( 8u );
+
+  std::vector<partition_view::block_id> node_block( aig.size(), 0 );
+  node_block[0] = -1;
+  aig.foreach_gate( [&]( auto const& n ) {
+    node_block[n] = ( n * 3u ) / aig.size();
+  } );
+
+  partition_view aig_p{ aig };
+  auto parts = aig_p.construct_from_partition( 3, node_block );
+  auto const res = aig_p.reunite( parts );
+  auto const& st = aig_p.stats();
+
+  /* cut hyperedges and km1 as defined on the hypergraph */
+  auto const& indices = aig_p.hyperedge_indices();
+  auto const& pins = aig_p.hyperedges();
+  uint32_t num_cut = 0u;
+  uint64_t km1 = 0u;
+  for ( auto e = 0u; e < aig_p.num_hyperedges(); ++e )
+  {
+    std::vector<int> blocks;
+    for ( auto i = indices[e]; i < indices[e + 1]; ++i )
+    {
+      blocks.push_back( node_block[pins[i] + 1u] );
+    }
+    std::sort( blocks.begin(), blocks.end() );
+    auto const lambda = std::unique( blocks.begin(), blocks.end() ) - blocks.begin();
+    num_cut += lambda > 1 ? 1u : 0u;
+    km1 += lambda - 1;
+  }
+  CHECK( st.num_cut_hyperedges == num_cut );
+  CHECK( st.km1 == km1 );
+
+  REQUIRE( st.blocks.size() == 3u );
+  uint32_t num_gates = 0u, max_gates = 0u;
+  for ( auto i = 0u; i < 3u; ++i )
+  {
+    CHECK( st.blocks[i].num_gates == std::get<0>( parts[i] ).num_gates() );
+    CHECK( st.blocks[i].num_pis == std::get<0>( parts[i] ).num_pis() );
+    CHECK( st.blocks[i].num_pos == std::get<0>( parts[i] ).num_pos() );
+    num_gates += st.blocks[i].num_gates;
+    max_gates = std::max( max_gates, st.blocks[i].num_gates );
+  }
+  CHECK( num_gates == aig.num_gates() );
+  CHECK( st.imbalance == Approx( 3.0 * max_gates / aig.num_gates() - 1.0 ) );
+  CHECK( to_seconds( st.time_extract ) > 0.0 );
+  CHECK( to_seconds( st.time_reunite ) > 0.0 );
+
+  nlohmann::json j = st;
+  CHECK( j["cut_hyperedges"] == num_cut );
+  CHECK( j["blocks"].size() == 3u );
+  CHECK( j["blocks"][1]["gates"] == st.blocks[1].num_gates );
+}
@@ -0,0 +1,118 @@
+#include <catch.hpp>
+
+#include <thread>
+#include <vector>
+
+#include <mtkahypar.h>
+
+#include <kitty/dynamic_truth_table.hpp>
+#include <mockturtle/algorithms/simulation.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/utils/block_memory_model.hpp>
+#include <mockturtle/views/partition_view.hpp>
+
+#include "partition_networks.hpp"
+
+using namespace mockturtle;
+
+TEST_CASE( "partition recursively to a target block size", "[partition]" )
+{
+  mt_kahypar_initialize( std::thread::hardware_concurrency(), true );
+
+  auto const aig = multiplier_aig( 6u );
+  partition_view_params ps;
+  ps.max_block_size = 40u;
+  partition_view aig_p{ aig, ps };
+
+  mt_kahypar_error_t error{};
+  auto const tree = aig_p.partition_recursively( &error );
+  REQUIRE( tree );
+  CHECK( tree->nodes[0].num_gates == aig.num_gates() );
+  CHECK( tree->nodes[0].height > 0u );
+
+  /* leaves are the blocks of node_block and fit the target size */
+  std::vector<uint32_t> block_gates( tree->num_blocks, 0u );
+  aig.foreach_gate( [&]( auto const& n ) {
+    block_gates[tree->node_block[n]]++;
+  } );
+  for ( auto const& tn : tree->nodes )
+  {
+    if ( tn.children.empty() )
+    {
+      CHECK( tn.num_gates <= ps.max_block_size );
+      CHECK( block_gates[tn.block] == tn.num_gates );
+    }
+    else
+    {
+      uint32_t num_gates = 0u;
+      for ( auto const& c : tn.children )
+      {
+        num_gates += tree->nodes[c].num_gates;
+        CHECK( tn.height > tree->nodes[c].height );
+      }
+      CHECK( num_gates == tn.num_gates );
+    }
+  }
+
+  uint32_t num_merged;
+  CHECK( tree->merge_leaves( 0u, num_merged ).size() == tree->num_blocks );
+  CHECK( num_merged == tree->num_blocks );
+  CHECK( tree->merge_leaves( tree->nodes[0].height, num_merged ) == std::vector<int>( tree->num_blocks, 0 ) );
+  CHECK( num_merged == 1u );
+
+  /* the leaves can be extracted and reunited */
+  auto parts = aig_p.construct_from_partition( tree->num_blocks, tree->node_block );
+  std::vector<int> origin;
+  auto const res = aig_p.reunite( parts, &origin );
+  CHECK( origin.size() == res.size() );
+  res.foreach_gate( [&]( auto const& n ) {
+    CHECK( origin[n] >= 0 );
+  } );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, default_simulator<kitty::dynamic_truth_table>( aig.num_pis() ) ) ==
+         simulate<kitty::dynamic_truth_table>( aig, default_simulator<kitty::dynamic_truth_table>( aig.num_pis() ) ) );
+}
+
+TEST_CASE( "partition recursively to a memory budget", "[partition]" )
+{
+  mt_kahypar_initialize( std::thread::hardware_concurrency(), true );
+
+  /* superlinear models fit fewer gates into twice the budget */
+  auto const model = sim_resub_memory_model();
+  auto const g = model.max_gates( model.gate_bytes( 2u ), 1u << 20 );
+  CHECK( model.block_bytes( model.gate_bytes( 2u ) * g, g ) <= double( 1u << 20 ) );
+  CHECK( model.block_bytes( model.gate_bytes( 2u ) * ( g + 1u ), g + 1u ) > double( 1u << 20 ) );
+  CHECK( model.max_gates( model.gate_bytes( 2u ), 2u << 20 ) < 2u * g );
+
+  auto const aig = multiplier_aig( 6u );
+  std::vector<aig_network::node> gates;
+  aig.foreach_gate( [&]( auto const& n ) {
+    gates.push_back( n );
+  } );
+
+  partition_view_params ps;
+  ps.memory_model = emap_memory_model( 100u );
+  partition_view unbounded{ aig, ps };
+  ps.max_block_memory = unbounded.estimated_memory( gates ) / 5u;
+  partition_view aig_p{ aig, ps };
+  CHECK( aig_p.use_vertex_weights() );
+  CHECK( aig_p.num_blocks_for_memory() >= 5u );
+
+  /* gates with more fanouts weigh more */
+  auto const& weights = aig_p.vertex_weights();
+  aig.foreach_gate( [&]( auto const& n ) {
+    CHECK( weights[n - 1u] >= 16 );
+    CHECK( ( aig.fanout_size( n ) < 2u || weights[n - 1u] > 16 ) );
+  } );
+
+  mt_kahypar_error_t error{};
+  auto const tree = aig_p.partition_recursively( &error );
+  REQUIRE( tree );
+  std::vector<std::vector<aig_network::node>> block_gates( tree->num_blocks );
+  aig.foreach_gate( [&]( auto const& n ) {
+    block_gates[tree->node_block[n]].push_back( n );
+  } );
+  for ( auto const& b : block_gates )
+  {
+    CHECK( aig_p.estimated_memory( b ) <= ps.max_block_memory );
+  }
+}
@@ -0,0 +1,149 @@
+#include <catch.hpp>
+
+#include <vector>
+
+#include <mtkahypar.h>
+
+#include <kitty/dynamic_truth_table.hpp>
+#include <mockturtle/algorithms/aig_balancing.hpp>
+#include <mockturtle/algorithms/simulation.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/views/partition_view.hpp>
+
+#include "partition_networks.hpp"
+
+using namespace mockturtle;
+
+TEST_CASE( "reunite all parts in a single pass", "[partition]" )
+{
+  auto const aig = multiplier_aig( 8u );
+  auto const tts = simulate<kitty::dynamic_truth_table>( aig, default_simulator<kitty::dynamic_truth_table>( aig.num_pis() ) );
+
+  partition_view aig_p{ aig };
+  auto parts = aig_p.construct_from_partition( 4, chunk_partition( aig_p, 4 ) );
+
+  /* unchanged parts rebuild the same network */
+  auto const same = aig_p.reunite( parts );
+  CHECK( same.num_gates() == aig.num_gates() );
+  CHECK( simulate<kitty::dynamic_truth_table>( same, default_simulator<kitty::dynamic_truth_table>( same.num_pis() ) ) == tts );
+  CHECK( aig_p.rejected_blocks().empty() );
+
+  /* optimized parts */
+  for ( auto& part : parts )
+  {
+    aig_balance( std::get<0>( part ) );
+  }
+  auto const res = aig_p.reunite( parts );
+  CHECK( res.num_pis() == aig.num_pis() );
+  CHECK( res.num_pos() == aig.num_pos() );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, default_simulator<kitty::dynamic_truth_table>( res.num_pis() ) ) == tts );
+  res.foreach_gate( [&]( auto const& n ) {
+    CHECK( res.fanout_size( n ) > 0u );
+  } );
+}
+
+TEST_CASE( "reunite removes gates left dangling by strashing", "[partition]" )
+{
+  /* o1 and o2 are equal but structurally different, h = o1 & !o2 is constant */
+  aig_network aig;
+  const auto a = aig.create_pi();
+  const auto b = aig.create_pi();
+  const auto c = aig.create_pi();
+  const auto o1 = aig.create_and( aig.create_and( a, b ), c );
+  const auto o2 = aig.create_and( a, aig.create_and( b, c ) );
+  aig.create_po( aig.create_and( o1, !o2 ) );
+
+  partition_view aig_p{ aig };
+  std::vector<int> const node_block{ -1, 0, 0, 0, 0, 0, 0, 0, 1 };
+  auto parts = aig_p.construct_from_partition( 2, node_block );
+  REQUIRE( std::get<2>( parts[0] ).size() == 2u );
+
+  /* the optimized block computes both outputs with the same gate */
+  aig_network opt;
+  const auto i1 = opt.create_pi();
+  const auto i2 = opt.create_pi();
+  const auto i3 = opt.create_pi();
+  const auto t = opt.create_and( opt.create_and( i1, i2 ), i3 );
+  opt.create_po( t );
+  opt.create_po( t );
+  std::get<0>( parts[0] ) = opt;
+
+  /* h becomes constant after both gates of block 0 have been created */
+  std::vector<int> origin;
+  auto const res = aig_p.reunite( parts, &origin );
+  CHECK( res.num_gates() == 0u );
+  CHECK( res.po_at( 0 ) == res.get_constant( false ) );
+  CHECK( origin.size() == res.size() );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, default_simulator<kitty::dynamic_truth_table>( 3u ) ) ==
+         simulate<kitty::dynamic_truth_table>( aig, default_simulator<kitty::dynamic_truth_table>( 3u ) ) );
+}
+
+TEST_CASE( "parallel reunion is deterministic", "[partition]" )
+{
+  auto const aig = multiplier_aig( 8u );
+
+  partition_view_params ps;
+  ps.num_threads = 1u;
+  partition_view aig_p{ aig, ps };
+  auto parts = aig_p.construct_from_partition( 8, chunk_partition( aig_p, 8 ) );
+  for ( auto& part : parts )
+  {
+    aig_balance( std::get<0>( part ) );
+  }
+  std::vector<int> origin_seq, origin_par;
+  auto const res_seq = aig_p.reunite( parts, &origin_seq );
+
+  ps.num_threads = 4u;
+  partition_view aig_p_par{ aig, ps };
+  aig_p_par.construct_from_partition( 8, chunk_partition( aig_p_par, 8 ) );
+  auto const res_par = aig_p_par.reunite( parts, &origin_par );
+
+  /* same nodes in the same order */
+  REQUIRE( res_seq.size() == res_par.size() );
+  CHECK( origin_seq == origin_par );
+  res_seq.foreach_gate( [&]( auto const& n ) {
+    res_seq.foreach_fanin( n, [&]( auto const& fi, auto i ) {
+      CHECK( fi == res_par._storage->nodes[n].children[i] );
+    } );
+  } );
+  res_seq.foreach_po( [&]( auto const& f, auto i ) {
+    CHECK( f == res_par.po_at( i ) );
+  } );
+}
+
+TEST_CASE( "reunite rejects parts that close a cycle", "[partition]" )
+{
+  aig_network aig;
+  const auto x1 = aig.create_pi();
+  const auto x2 = aig.create_pi();
+  const auto x3 = aig.create_pi();
+  const auto x4 = aig.create_pi();
+  const auto g1 = aig.create_and( x1, x2 );
+  const auto g2 = aig.create_and( g1, x3 );
+  const auto g3 = aig.create_and( g2, x4 );
+  aig.create_po( g2 );
+  aig.create_po( g3 );
+
+  partition_view aig_p{ aig };
+  std::vector<mt_kahypar_partition_id_t> partition{ 0, 0, 1, 0, 0, 1, 0 };
+  auto parts = aig_p.construct_from_partition( 2, aig_p.node_to_block( partition.data(), partition.size() ) );
+  REQUIRE( std::get<1>( parts[0] ) == std::vector<aig_network::node>{ 1, 2, 4, 6 } );
+  REQUIRE( std::get<2>( parts[0] ).size() == 2u );
+
+  /* g1 = g1 | ( g1 & g2 ) structurally depends on g2, which depends on g1 */
+  aig_network cyclic;
+  const auto i1 = cyclic.create_pi();
+  const auto i2 = cyclic.create_pi();
+  const auto i4 = cyclic.create_pi();
+  const auto i_g2 = cyclic.create_pi();
+  const auto t = cyclic.create_and( i1, i2 );
+  cyclic.create_po( cyclic.create_or( t, cyclic.create_and( t, i_g2 ) ) );
+  cyclic.create_po( cyclic.create_and( i_g2, i4 ) );
+  std::get<0>( parts[0] ) = cyclic;
+
+  auto const res = aig_p.reunite( parts );
+  CHECK( aig_p.rejected_blocks() == std::vector<int>{ 0, 1 } );
+  CHECK( res.num_gates() == 3u );
+  CHECK( simulate<kitty::dynamic_truth_table>( res, default_simulator<kitty::dynamic_truth_table>( 4u ) ) ==
+         simulate<kitty::dynamic_truth_table>( aig, default_simulator<kitty::dynamic_truth_table>( 4u ) ) );
+}
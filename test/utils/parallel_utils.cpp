@@ -0,0 +1,42 @@
+#include <catch.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <mockturtle/utils/parallel_utils.hpp>
+
+using namespace mockturtle;
+
+TEST_CASE( "run all tasks of a parallel for", "[parallel_utils]" )
+{
+  /* Catch2 is not thread-safe, so the workers only record and the checks run afterwards */
+  std::vector<uint32_t> results( 100u, 0u );
+  std::vector<uint32_t> thread_ids( 100u, 0u );
+  std::atomic<uint32_t> num_calls{ 0u };
+  parallel_for( 100u, 4u, [&]( uint32_t i, uint32_t thread_id ) {
+    results[i] = i * i;
+    thread_ids[i] = thread_id;
+    ++num_calls;
+  } );
+  CHECK( num_calls == 100u );
+  for ( auto i = 0u; i < results.size(); ++i )
+  {
+    CHECK( results[i] == i * i );
+    CHECK( thread_ids[i] < 4u );
+  }
+
+  CHECK( resolve_num_threads( 3u ) == 3u );
+  CHECK( resolve_num_threads( 0u ) >= 1u );
+}
+
+TEST_CASE( "propagate exceptions of a parallel for", "[parallel_utils]" )
+{
+  CHECK_THROWS_AS( parallel_for( 10u, 2u, []( uint32_t i, uint32_t ) {
+                     if ( i == 7u )
+                     {
+                       throw std::runtime_error( "task failed" );
+                     }
+                   } ),
+                   std::runtime_error );
+}
@@ -0,0 +1,68 @@
+#include <catch.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mockturtle/utils/process_utils.hpp>
+
+#if MOCKTURTLE_HAS_FORK
+#include <cerrno>
+#include <sys/wait.h>
+#endif
+
+using namespace mockturtle;
+
+TEST_CASE( "run tasks in worker processes", "[process_utils]" )
+{
+  std::vector<std::string> results( 10u );
+  std::vector<process_status> status( 10u, process_status::failed );
+  run_in_processes(
+      10u, 3u, 0.0, 64u,
+      []( uint32_t i, std::string& result ) {
+        result = std::string( i, 'x' );
+        if ( i == 9u )
+        {
+          result.resize( 100u );
+        }
+      },
+      [&]( uint32_t i, process_status s, char const* data, size_t size ) {
+        status[i] = s;
+        results[i] = std::string( data, size );
+      } );
+
+  for ( auto i = 0u; i < 9u; ++i )
+  {
+    CHECK( status[i] == process_status::success );
+    CHECK( results[i] == std::string( i, 'x' ) );
+  }
+  CHECK( status[9u] == process_status::overflow );
+}
+
+#if MOCKTURTLE_HAS_FORK
+TEST_CASE( "reap worker processes if the callback throws", "[process_utils]" )
+{
+  auto const start = std::chrono::steady_clock::now();
+  CHECK_THROWS_AS( run_in_processes(
+                       2u, 2u, 0.0, 64u,
+                       []( uint32_t i, std::string& ) {
+                         /* the second worker would run for a minute */
+                         if ( i == 1u )
+                         {
+                           std::this_thread::sleep_for( std::chrono::seconds( 60 ) );
+                         }
+                       },
+                       []( uint32_t, process_status, char const*, size_t ) {
+                         throw std::runtime_error( "callback failed" );
+                       } ),
+                   std::runtime_error );
+
+  /* the running worker was killed, and no worker is left behind */
+  CHECK( std::chrono::steady_clock::now() - start < std::chrono::seconds( 30 ) );
+  errno = 0;
+  CHECK( waitpid( -1, nullptr, WNOHANG ) == -1 );
+  CHECK( errno == ECHILD );
+}
+#endif
@@ -0,0 +1,95 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <kitty/dynamic_truth_table.hpp>
+#include <mockturtle/algorithms/cut_enumeration.hpp>
+#include <mockturtle/algorithms/simulation.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/traits.hpp>
+#include <mockturtle/views/block_view.hpp>
+#include <mockturtle/views/depth_view.hpp>
+#include <mockturtle/views/partition_view.hpp>
+
+#include "../partition/partition_networks.hpp"
+
+using namespace mockturtle;
+
+TEST_CASE( "create block view on AIG", "[block_view]" )
+{
+  aig_network aig;
+  const auto a = aig.create_pi();
+  const auto b = aig.create_pi();
+  const auto c = aig.create_pi();
+  const auto f1 = aig.create_and( a, b );
+  const auto f2 = aig.create_and( f1, c );
+  const auto f3 = aig.create_and( !f1, !c );
+  aig.create_po( f2 );
+  aig.create_po( f3 );
+
+  /* block of f2 and f3, reading f1 and c */
+  block_view view( aig, { aig.get_node( c ), aig.get_node( f1 ) }, { f2, f3 }, { aig.get_node( f2 ), aig.get_node( f3 ) } );
+  CHECK( is_network_type_v<decltype( view )> );
+  CHECK( view.size() == 5u );
+  CHECK( view.num_pis() == 2u );
+  CHECK( view.num_pos() == 2u );
+  CHECK( view.num_gates() == 2u );
+  CHECK( view.is_pi( aig.get_node( f1 ) ) );
+  CHECK( !view.is_pi( aig.get_node( a ) ) );
+  CHECK( view.belongs_to( aig.get_node( f3 ) ) );
+  CHECK( !view.belongs_to( aig.get_node( f1 ) ) );
+
+  uint32_t num_nodes = 0u;
+  view.foreach_node( [&]( auto const& n, auto i ) {
+    CHECK( view.node_to_index( n ) == i );
+    CHECK( view.index_to_node( i ) == n );
+    ++num_nodes;
+  } );
+  CHECK( num_nodes == view.size() );
+
+  /* fanins stop at the block inputs */
+  uint32_t num_fanins = 0u;
+  view.foreach_fanin( aig.get_node( f1 ), [&]( auto const& ) { ++num_fanins; } );
+  CHECK( num_fanins == 0u );
+
+  auto const tts = simulate<kitty::static_truth_table<2u>>( view );
+  CHECK( tts[0]._bits == 0x8 );
+  CHECK( tts[1]._bits == 0x1 );
+}
+
+TEST_CASE( "analyze the blocks of a partition in place", "[block_view]" )
+{
+  auto const aig = adder_aig( 8u );
+  std::vector<partition_view::block_id> node_block( aig.size(), 0 );
+  node_block[0] = -1;
+  aig.foreach_gate( [&]( auto const& n ) {
+    node_block[n] = ( n * 3u ) / aig.size();
+  } );
+
+  partition_view aig_p{ aig };
+  auto const views = aig_p.block_views( 3, node_block );
+  REQUIRE( views.size() == 3u );
+
+  uint32_t num_gates = 0u;
+  for ( auto const& view : views )
+  {
+    num_gates += view.num_gates();
+
+    /* the view behaves like the copy of its block */
+    auto const copy = view.materialize();
+    CHECK( copy.num_pis() == view.num_pis() );
+    CHECK( copy.num_pos() == view.num_pos() );
+    CHECK( copy.num_gates() == view.num_gates() );
+    CHECK( simulate<kitty::dynamic_truth_table>( view, { view.num_pis() } ) == simulate<kitty::dynamic_truth_table>( copy, { copy.num_pis() } ) );
+    CHECK( depth_view{ view }.depth() == depth_view{ copy }.depth() );
+
+    cut_enumeration_params ps;
+    ps.cut_size = 4u;
+    auto const cuts = cut_enumeration( view, ps );
+    view.foreach_gate( [&]( auto const& n ) {
+      CHECK( cuts.cuts( view.node_to_index( n ) ).size() > 0u );
+    } );
+  }
+  CHECK( num_gates == aig.num_gates() );
+}